@@ -0,0 +1,359 @@
+// Native microbenchmarks for the allocator core, without JS or N-API cost.
+// Usage: ./build/Release/microbench [--threads 1,4] [--ops N] [--filter text]
+//                                   [--huge-pages off|thp|hugetlb]
+//
+// Prints one JSON document on stdout (for regression tracking) and a
+// readable line per case on stderr. Every case runs the same workload
+// against r_alloc (or an arena) and, where it makes sense, system malloc.
+//
+// Workloads:
+//   pair   alloc + free of one block, repeated
+//   batch  BATCH allocs, then free them all (bump arenas: one reset)
+//   churn  WINDOW live blocks, each op frees a random one and allocates again
+//   session  SESSIONS live 128 byte records (tens of MB), each op reads and
+//          writes a random one; every 16th op replaces it. Run it once per
+//          --huge-pages mode to see the dTLB cost of 4KB pages.
+//
+// dTLB load misses are counted with perf_event_open where the kernel
+// allows it (perf_event_paranoid <= 2), otherwise reported as null.
+#include "../src/allocator.h"
+#include "../src/arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BATCH 1000
+#define WINDOW 4096
+#define SIZE_TABLE 4096 // pregenerated sizes/indices, so no RNG in timed loops
+#define DEFAULT_OPS 2000000
+#define SESSIONS (256 * 1024) // x 128 bytes = 32MB, far past the dTLB reach of 4KB pages
+#define SESSION_SIZE 128
+
+// --- SIZE DISTRIBUTIONS ---
+struct Distribution {
+    const char* name;
+    uint32_t min, max;
+    bool log_uniform;  // fixed when min == max
+};
+
+static const Distribution FIXED[] = {
+    { "16", 16, 16, false }, { "64", 64, 64, false }, { "256", 256, 256, false },
+    { "1024", 1024, 1024, false }, { "4096", 4096, 4096, false }, { "65536", 65536, 65536, false },
+};
+static const Distribution RANDOM[] = {
+    { "rand16-1024", 16, 1024, false },
+    { "rand16-64k", 16, 65536, true },
+};
+
+static uint32_t xorshift(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static std::vector<uint32_t> make_sizes(const Distribution& d, uint32_t seed) {
+    std::vector<uint32_t> sizes(SIZE_TABLE);
+    for (uint32_t& size : sizes) {
+        if (d.min == d.max) {
+            size = d.min;
+        } else if (d.log_uniform) {
+            double t = (xorshift(&seed) & 0xffffff) / (double)0x1000000;
+            size = (uint32_t)(d.min * pow((double)d.max / d.min, t));
+        } else {
+            size = d.min + xorshift(&seed) % (d.max - d.min + 1);
+        }
+    }
+    return sizes;
+}
+
+// --- ALLOCATORS UNDER TEST ---
+struct HeapAlloc {
+    static const char* name() { return "r_alloc"; }
+    static const bool can_free = true;
+    void* alloc(size_t size) { return r_alloc(size, 0); }
+    void free(void* ptr) { r_free(ptr); }
+    void reset() {}
+};
+
+struct MallocAlloc {
+    static const char* name() { return "malloc"; }
+    static const bool can_free = true;
+    void* alloc(size_t size) { return malloc(size); }
+    void free(void* ptr) { ::free(ptr); }
+    void reset() {}
+};
+
+template <lifetime_t POLICY>
+struct ArenaAlloc {
+    static const char* name() {
+        return POLICY == LIFETIME_TRANSIENT ? "arena_transient"
+             : POLICY == LIFETIME_INTERMEDIATE ? "arena_slab" : "arena_persistent";
+    }
+    static const bool can_free = POLICY == LIFETIME_INTERMEDIATE;
+    arena_t* arena;
+
+    ArenaAlloc() { arena = create_arena(1024 * 1024, POLICY); }
+    ~ArenaAlloc() { r_destroy(arena); }
+    void* alloc(size_t size) { return r_arena(arena, size, 0); }
+    void free(void* ptr) { r_arena_free(arena, ptr); }
+    void reset() {
+        if (POLICY == LIFETIME_PERSISTENT) { // r_reset keeps persistent memory
+            r_destroy(arena);
+            arena = create_arena(1024 * 1024, POLICY);
+        } else {
+            r_reset(arena);
+        }
+    }
+};
+
+// --- WORKLOADS ---
+// Each returns the number of allocator calls it made
+enum Workload { PAIR, BATCH_FREE, CHURN, SESSION };
+static const char* WORKLOAD_NAMES[] = { "pair", "batch", "churn", "session" };
+
+template <typename A>
+static uint64_t run_workload(Workload workload, const std::vector<uint32_t>& sizes,
+                             const std::vector<uint32_t>& slots, uint64_t ops) {
+    A a;
+    uint64_t calls = 0;
+    if (workload == PAIR) {
+        for (uint64_t i = 0; i < ops; i++) {
+            void* p = a.alloc(sizes[i & (SIZE_TABLE - 1)]);
+            if (p) *(volatile char*)p = 1;
+            a.free(p);
+        }
+        calls = ops * 2;
+    } else if (workload == BATCH_FREE) {
+        void* live[BATCH];
+        for (uint64_t done = 0; done < ops; done += BATCH) {
+            for (int i = 0; i < BATCH; i++) {
+                live[i] = a.alloc(sizes[(done + i) & (SIZE_TABLE - 1)]);
+                if (live[i]) *(volatile char*)live[i] = 1;
+            }
+            if (A::can_free) {
+                for (int i = 0; i < BATCH; i++) a.free(live[i]);
+                calls += 2 * BATCH;
+            } else {
+                a.reset();
+                calls += BATCH + 1;
+            }
+        }
+    } else if (workload == CHURN) {
+        std::vector<void*> live(WINDOW);
+        for (int i = 0; i < WINDOW; i++) live[i] = a.alloc(sizes[i & (SIZE_TABLE - 1)]);
+        for (uint64_t i = 0; i < ops; i++) {
+            uint32_t slot = slots[i & (SIZE_TABLE - 1)];
+            a.free(live[slot]);
+            live[slot] = a.alloc(sizes[(i * 7) & (SIZE_TABLE - 1)]);
+            if (live[slot]) *(volatile char*)live[slot] = 1;
+        }
+        for (int i = 0; i < WINDOW; i++) a.free(live[i]);
+        calls = ops * 2;
+    } else {
+        std::vector<uint64_t*> sessions(SESSIONS);
+        for (int i = 0; i < SESSIONS; i++) {
+            sessions[i] = (uint64_t*)a.alloc(SESSION_SIZE);
+            if (sessions[i]) memset(sessions[i], 0, SESSION_SIZE);
+        }
+        uint32_t rng = 0x2545f491;
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            uint32_t slot = xorshift(&rng) & (SESSIONS - 1);
+            uint64_t* session = sessions[slot];
+            if (!session) continue;
+            if ((i & 15) == 15) {
+                a.free(session);
+                session = sessions[slot] = (uint64_t*)a.alloc(SESSION_SIZE);
+                if (!session) continue;
+                session[0] = 0;
+                session[15] = 0;
+            }
+            sum += session[0] + session[15]; // first and last cache line
+            session[0] = i;
+            session[15] = sum;
+        }
+        for (int i = 0; i < SESSIONS; i++) a.free(sessions[i]);
+        calls = ops;
+    }
+    return calls;
+}
+
+// --- RUNNER ---
+struct Result {
+    std::string name;
+    const char* allocator;
+    const char* workload;
+    const char* sizes;
+    int threads;
+    uint64_t calls;
+    double seconds;
+    int64_t dtlb_misses; // -1 = counter unavailable
+};
+
+static std::vector<Result> results;
+
+// dTLB load misses of this thread and the threads it creates afterwards
+// (inherit), user space only. -1 if the kernel refuses the counter.
+static int open_dtlb_counter() {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static int64_t read_counter(int fd) {
+    uint64_t value;
+    if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) return -1;
+    return (int64_t)value;
+}
+
+template <typename A>
+static void run_case(Workload workload, const Distribution& dist, int threads,
+                     uint64_t ops, const char* filter) {
+    std::string name = std::string(A::name()) + "/" + WORKLOAD_NAMES[workload] + "/" +
+                       dist.name + "/t" + std::to_string(threads);
+    if (filter && !strstr(name.c_str(), filter)) return;
+
+    std::vector<std::vector<uint32_t>> sizes, slots;
+    for (int t = 0; t < threads; t++) {
+        sizes.push_back(make_sizes(dist, 0x9e3779b9u + t));
+        Distribution window = { "", 0, WINDOW - 1, false };
+        slots.push_back(make_sizes(window, 0x85ebca6bu + t));
+    }
+
+    // Threads wait on `go` so they all start together
+    int counter = open_dtlb_counter();
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<uint64_t> calls(0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            ready++;
+            while (!go.load()) std::this_thread::yield();
+            calls += run_workload<A>(workload, sizes[t], slots[t], ops);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    if (counter >= 0) ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (std::thread& thread : pool) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int64_t misses = read_counter(counter);
+    if (counter >= 0) close(counter);
+
+    Result r = { name, A::name(), WORKLOAD_NAMES[workload], dist.name, threads, calls.load(), seconds, misses };
+    results.push_back(r);
+    fprintf(stderr, "%-40s %8.2f ns/call  %8.2f M calls/sec", name.c_str(),
+            seconds * 1e9 * threads / r.calls, r.calls / seconds / 1e6);
+    if (misses >= 0) fprintf(stderr, "  %6.3f dTLB misses/call", (double)misses / r.calls);
+    fprintf(stderr, "\n");
+}
+
+static const char* HUGE_PAGE_NAMES[] = { "off", "thp", "hugetlb" };
+
+static void print_json() {
+    printf("{\n  \"hardware_threads\": %u,\n  \"huge_pages\": \"%s\",\n  \"results\": [\n",
+           std::thread::hardware_concurrency(), HUGE_PAGE_NAMES[r_huge_pages()]);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        char misses[32] = "null";
+        if (r.dtlb_misses >= 0) snprintf(misses, sizeof(misses), "%.4f", (double)r.dtlb_misses / r.calls);
+        printf("    {\"name\": \"%s\", \"allocator\": \"%s\", \"workload\": \"%s\", \"sizes\": \"%s\", "
+               "\"threads\": %d, \"calls\": %lu, \"seconds\": %.6f, \"ns_per_call\": %.3f, \"mcalls_per_sec\": %.3f, "
+               "\"dtlb_misses_per_call\": %s}%s\n",
+               r.name.c_str(), r.allocator, r.workload, r.sizes, r.threads, (unsigned long)r.calls,
+               r.seconds, r.seconds * 1e9 * r.threads / r.calls, r.calls / r.seconds / 1e6, misses,
+               i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> thread_counts = { 1 };
+    unsigned hw = std::thread::hardware_concurrency();
+    if (hw > 1) thread_counts.push_back(hw < 8 ? (int)hw : 8);
+    uint64_t ops = DEFAULT_OPS;
+    const char* filter = NULL;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--ops")) {
+            ops = strtoull(argv[i + 1], NULL, 10);
+        } else if (!strcmp(argv[i], "--filter")) {
+            filter = argv[i + 1];
+        } else if (!strcmp(argv[i], "--huge-pages")) {
+            for (int mode = HUGE_PAGES_OFF; mode <= HUGE_PAGES_HUGETLB; mode++) {
+                if (!strcmp(argv[i + 1], HUGE_PAGE_NAMES[mode])) r_set_huge_pages(mode);
+            }
+        } else if (!strcmp(argv[i], "--threads")) {
+            thread_counts.clear();
+            for (char* tok = strtok(argv[i + 1], ","); tok; tok = strtok(NULL, ",")) {
+                thread_counts.push_back(atoi(tok));
+            }
+        }
+    }
+    ops = (ops + BATCH - 1) / BATCH * BATCH;
+
+    // 64KB churn keeps 256MB live per thread, so lift the default 1GB cap
+    init_heap_config(64 * 1024 * 1024, 16ULL * 1024 * 1024 * 1024);
+    for (int threads : thread_counts) {
+        // General heap vs malloc, every workload and distribution
+        for (int w = PAIR; w <= CHURN; w++) {
+            for (const Distribution& d : FIXED) {
+                run_case<HeapAlloc>((Workload)w, d, threads, ops, filter);
+                run_case<MallocAlloc>((Workload)w, d, threads, ops, filter);
+            }
+            for (const Distribution& d : RANDOM) {
+                run_case<HeapAlloc>((Workload)w, d, threads, ops, filter);
+                run_case<MallocAlloc>((Workload)w, d, threads, ops, filter);
+            }
+        }
+
+        // Bump arenas: batch only (no individual frees)
+        for (const Distribution& d : FIXED) {
+            run_case<ArenaAlloc<LIFETIME_TRANSIENT>>(BATCH_FREE, d, threads, ops, filter);
+            run_case<ArenaAlloc<LIFETIME_PERSISTENT>>(BATCH_FREE, d, threads, ops, filter);
+        }
+        run_case<ArenaAlloc<LIFETIME_TRANSIENT>>(BATCH_FREE, RANDOM[0], threads, ops, filter);
+
+        // Slab arena, one case per size class
+        for (uint32_t size = 32; size <= 4096; size *= 2) {
+            std::string label = std::to_string(size);
+            Distribution d = { strdup(label.c_str()), size, size, false };
+            for (int w = PAIR; w <= CHURN; w++) {
+                run_case<ArenaAlloc<LIFETIME_INTERMEDIATE>>((Workload)w, d, threads, ops, filter);
+            }
+        }
+        for (int w = PAIR; w <= CHURN; w++) {
+            run_case<ArenaAlloc<LIFETIME_INTERMEDIATE>>((Workload)w, RANDOM[0], threads, ops, filter);
+        }
+
+        // Random access over a large live set (see --huge-pages)
+        static const Distribution session = { "128", SESSION_SIZE, SESSION_SIZE, false };
+        run_case<HeapAlloc>(SESSION, session, threads, ops, filter);
+        run_case<MallocAlloc>(SESSION, session, threads, ops, filter);
+        run_case<ArenaAlloc<LIFETIME_INTERMEDIATE>>(SESSION, session, threads, ops, filter);
+    }
+
+    print_json();
+    return 0;
+}
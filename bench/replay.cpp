@@ -0,0 +1,281 @@
+// Native replay driver for allocation traces (see src/trace.h).
+// Record:  R_ALLOC_TRACE=app.trace node server.js   (or startTrace/stopTrace)
+// Replay:  ./build/Release/replay app.trace [--malloc] [--touch]
+//
+//   --malloc  replay against glibc malloc/free instead of r_alloc. Arena
+//             allocations become mallocs, and r_reset/r_destroy free
+//             whatever the arena still holds, which is what the app would
+//             have to do without arenas.
+//   --touch   write every allocated byte, so RSS reflects real use
+//
+// The trace is replayed twice on one thread: an untimed-per-op pass for
+// throughput, then (after freeing everything) an instrumented pass for
+// per-op latency percentiles. Traces recorded from several workers are
+// replayed in the order the calls were recorded.
+#include "../src/allocator.h"
+#include "../src/arena.h"
+#include "../src/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static inline uint64_t now_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+static double rss_mb() {
+    long pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        long size;
+        if (fscanf(statm, "%ld %ld", &size, &pages) != 2) pages = 0;
+        fclose(statm);
+    }
+    return (double)pages * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+static double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0; // KB on Linux
+}
+
+// --- BACKENDS ---
+// All bookkeeping is sized up front (prepare), so the replayer itself does
+// not allocate while the trace runs.
+struct RallocBackend {
+    static const char* name() { return "r_alloc"; }
+    std::vector<void*> objects;    // by trace id
+    std::vector<arena_t*> arenas;
+
+    void prepare(uint32_t max_id, uint32_t max_arena) {
+        objects.assign(max_id + 1, NULL);
+        arenas.assign(max_arena + 1, NULL);
+    }
+
+    void* alloc(size_t size, uint32_t align, uint32_t site_id) {
+        return align ? r_alloc_aligned(size, align, site_id) : r_alloc(size, site_id);
+    }
+    void free(void* ptr) { r_free(ptr); }
+    void arena_create(uint32_t id, size_t size, int policy, size_t max_size, uint32_t flags) {
+        arenas[id] = create_arena_ex(size, (lifetime_t)policy, max_size, flags);
+    }
+    void* arena_alloc(uint32_t arena, uint32_t id, size_t size, uint32_t align, uint32_t site_id) {
+        if (!arenas[arena]) return NULL;
+        return align ? r_arena_aligned(arenas[arena], size, align, site_id)
+                     : r_arena(arenas[arena], size, site_id);
+    }
+    void arena_free(uint32_t arena, uint32_t id) {
+        if (arenas[arena] && objects[id]) r_arena_free(arenas[arena], objects[id]);
+    }
+    // A create that failed in the replay leaves the arena NULL
+    void arena_reset(uint32_t arena) {
+        if (arenas[arena]) r_reset(arenas[arena]);
+    }
+    void arena_destroy(uint32_t arena) {
+        if (arenas[arena]) r_destroy(arenas[arena]);
+        arenas[arena] = NULL;
+    }
+};
+
+struct MallocBackend {
+    static const char* name() { return "glibc malloc"; }
+    std::vector<void*> objects;    // by trace id
+    // Live objects of each arena, as intrusive lists over trace ids
+    std::vector<uint32_t> head, next, prev;
+
+    void prepare(uint32_t max_id, uint32_t max_arena) {
+        objects.assign(max_id + 1, NULL);
+        next.assign(max_id + 1, 0);
+        prev.assign(max_id + 1, 0);
+        head.assign(max_arena + 1, 0);
+    }
+
+    static void* aligned(size_t size, uint32_t align) {
+        if (!align) return malloc(size);
+        void* ptr = NULL;
+        return posix_memalign(&ptr, align < sizeof(void*) ? sizeof(void*) : align, size) ? NULL : ptr;
+    }
+    void* alloc(size_t size, uint32_t align, uint32_t site_id) { return aligned(size, align); }
+    void free(void* ptr) { ::free(ptr); }
+    void arena_create(uint32_t id, size_t size, int policy, size_t max_size, uint32_t flags) {}
+    void* arena_alloc(uint32_t arena, uint32_t id, size_t size, uint32_t align, uint32_t site_id) {
+        next[id] = head[arena];
+        prev[id] = 0;
+        if (head[arena]) prev[head[arena]] = id;
+        head[arena] = id;
+        return aligned(size, align);
+    }
+    // Objects the arena's reset already freed (traces from older
+    // recorders still free them afterwards) are no longer listed
+    void arena_free(uint32_t arena, uint32_t id) {
+        if (!objects[id]) return;
+        if (prev[id]) next[prev[id]] = next[id];
+        else head[arena] = next[id];
+        if (next[id]) prev[next[id]] = prev[id];
+        ::free(objects[id]);
+    }
+    void arena_reset(uint32_t arena) {
+        for (uint32_t id = head[arena]; id; id = next[id]) {
+            ::free(objects[id]);
+            objects[id] = NULL;
+        }
+        head[arena] = 0;
+    }
+    void arena_destroy(uint32_t arena) { arena_reset(arena); }
+};
+
+// --- REPLAY ---
+template <typename Backend, bool TIMED>
+static void replay(Backend& backend, const std::vector<trace_record_t>& trace,
+                   bool touch, uint32_t* latencies) {
+    std::vector<void*>& objects = backend.objects;
+    for (size_t i = 0; i < trace.size(); i++) {
+        const trace_record_t& r = trace[i];
+        uint64_t start = TIMED ? now_ticks() : 0;
+        switch (r.op) {
+        case TRACE_ALLOC:
+            objects[r.id] = backend.alloc(r.size, r.arg, r.site_id);
+            if (touch && objects[r.id]) memset(objects[r.id], 0xab, r.size);
+            break;
+        case TRACE_FREE:
+            if (objects[r.id]) backend.free(objects[r.id]);
+            objects[r.id] = NULL;
+            break;
+        case TRACE_ARENA_CREATE:
+            backend.arena_create(r.arena, r.size, r.policy, r.max_size, r.arg);
+            break;
+        case TRACE_ARENA_ALLOC:
+            objects[r.id] = backend.arena_alloc(r.arena, r.id, r.size, r.arg, r.site_id);
+            if (touch && objects[r.id]) memset(objects[r.id], 0xab, r.size);
+            break;
+        case TRACE_ARENA_FREE:
+            backend.arena_free(r.arena, r.id);
+            objects[r.id] = NULL;
+            break;
+        case TRACE_ARENA_RESET:
+            backend.arena_reset(r.arena);
+            break;
+        case TRACE_ARENA_DESTROY:
+            backend.arena_destroy(r.arena);
+            break;
+        }
+        if (TIMED) latencies[i] = (uint32_t)std::min<uint64_t>(now_ticks() - start, UINT32_MAX);
+    }
+}
+
+// Frees whatever the trace left alive, so the next pass starts clean
+template <typename Backend>
+static void cleanup(Backend& backend, const std::vector<trace_record_t>& trace, uint32_t max_arena) {
+    std::vector<void*>& objects = backend.objects;
+    std::vector<char> in_arena(objects.size(), 0);
+    std::vector<char> live_arena(max_arena + 1, 0);
+    for (const trace_record_t& r : trace) {
+        if (r.op == TRACE_ARENA_ALLOC) in_arena[r.id] = 1;
+        else if (r.op == TRACE_ARENA_CREATE) live_arena[r.arena] = 1;
+        else if (r.op == TRACE_ARENA_DESTROY) live_arena[r.arena] = 0;
+    }
+    for (size_t id = 0; id < objects.size(); id++) {
+        if (objects[id] && !in_arena[id]) backend.free(objects[id]);
+    }
+    for (uint32_t arena = 1; arena <= max_arena; arena++) {
+        if (live_arena[arena]) backend.arena_destroy(arena);
+    }
+    std::fill(objects.begin(), objects.end(), (void*)NULL);
+}
+
+template <typename Backend>
+static int run(Backend& backend, const char* path, const std::vector<trace_record_t>& trace,
+               uint32_t max_id, uint32_t max_arena, bool touch) {
+    backend.prepare(max_id, max_arena);
+    std::vector<uint32_t> latencies(trace.size());
+    double baseline_rss = rss_mb();
+
+    // Pass 1: throughput
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t tick_start = now_ticks();
+    replay<Backend, false>(backend, trace, touch, NULL);
+    uint64_t ticks = now_ticks() - tick_start;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double ticks_per_ns = ticks / (seconds * 1e9);
+    double peak_rss = peak_rss_mb();
+
+    // Pass 2: per-op latency
+    cleanup(backend, trace, max_arena);
+    replay<Backend, true>(backend, trace, touch, latencies.data());
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) {
+        size_t i = std::min(latencies.size() - 1, (size_t)(latencies.size() * p));
+        return latencies[i] / ticks_per_ns;
+    };
+
+    printf("trace:      %s (%zu ops, %u objects, %u arenas)\n", path, trace.size(), max_id, max_arena);
+    printf("backend:    %s%s\n", Backend::name(), touch ? " (touching memory)" : "");
+    printf("throughput: %.2fM ops/sec\n", trace.size() / seconds / 1e6);
+    printf("latency:    p50 %.0f ns | p90 %.0f ns | p99 %.0f ns | p99.9 %.0f ns | max %.0f ns\n",
+           pct(0.5), pct(0.9), pct(0.99), pct(0.999), latencies.back() / ticks_per_ns);
+    printf("peak RSS:   %.2f MB (%.2f MB above the loaded trace)\n", peak_rss, peak_rss - baseline_rss);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    bool use_malloc = false;
+    bool touch = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--malloc")) use_malloc = true;
+        else if (!strcmp(argv[i], "--touch")) touch = true;
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "usage: replay <trace> [--malloc] [--touch]\n");
+        return 1;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    trace_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != TRACE_MAGIC ||
+        header.record_size != sizeof(trace_record_t)) {
+        fprintf(stderr, "%s: not a trace file (or from another version)\n", path);
+        fclose(file);
+        return 1;
+    }
+    std::vector<trace_record_t> trace;
+    trace_record_t record;
+    while (fread(&record, sizeof(record), 1, file) == 1) trace.push_back(record);
+    fclose(file);
+    if (trace.empty()) {
+        fprintf(stderr, "%s: empty trace\n", path);
+        return 1;
+    }
+
+    uint32_t max_id = 0, max_arena = 0;
+    for (const trace_record_t& r : trace) {
+        max_id = std::max(max_id, r.id);
+        max_arena = std::max(max_arena, r.arena);
+    }
+
+    if (use_malloc) {
+        MallocBackend backend;
+        return run(backend, path, trace, max_id, max_arena, touch);
+    }
+    init_heap();
+    RallocBackend backend;
+    return run(backend, path, trace, max_id, max_arena, touch);
+}
@@ -5,7 +5,12 @@
       "sources": [ 
         "src/addon.cpp", 
         "src/allocator.cpp", 
-        "src/arena.cpp" 
+        "src/arena.cpp",
+        "src/views.cpp",
+        "src/handles.cpp",
+        "src/trace.cpp",
+        "src/structs.cpp",
+        "src/hashtable.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -16,6 +21,30 @@
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
       "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ]
+    },
+    {
+      "target_name": "replay",
+      "type": "executable",
+      "sources": [
+        "bench/replay.cpp",
+        "src/allocator.cpp",
+        "src/arena.cpp"
+      ],
+      "cflags_cc": [ "-O2", "-std=gnu++17" ],
+      "defines": [ "PROFILING_MODE=0" ],
+      "libraries": [ "-lpthread" ]
+    },
+    {
+      "target_name": "microbench",
+      "type": "executable",
+      "sources": [
+        "bench/microbench.cpp",
+        "src/allocator.cpp",
+        "src/arena.cpp"
+      ],
+      "cflags_cc": [ "-O2", "-std=gnu++17" ],
+      "defines": [ "PROFILING_MODE=0" ],
+      "libraries": [ "-lpthread", "-lm" ]
     }
   ]
 }
\ No newline at end of file
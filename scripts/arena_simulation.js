@@ -15,7 +15,9 @@ const sessionArena = myAllocator.createArena(10 * 1024 * 1024, LIFETIME.INTERMED
 const persistentArena = myAllocator.createArena(5 * 1024 * 1024, LIFETIME.PERSISTENT);
 
 // STATE
-const sessions = new Map(); // Maps ID -> Pointer (BigInt)
+// Maps ID -> Pointer (BigInt), kept in the session arena itself: the session
+// store never touches the V8 heap. Starts small and grows as sessions arrive.
+const sessions = myAllocator.createHashTable(sessionArena, 64);
 
 console.log("=== ARENA (Custom) Simulation ===");
 console.log("1. Filling Persistent Cache...");
@@ -33,23 +35,22 @@ for (let i = 0; i < TOTAL_OPS; i++) {
 
     // 30% Chance: Login (Alloc from Slab)
     if (r < 0.3) {
-        if (sessions.size < MAX_SESSIONS) {
+        if (myAllocator.hashCount(sessions) < MAX_SESSIONS) {
             const id = i;
             // O(1) Allocation from Free List
             const ptr = myAllocator.rArena(sessionArena, SESSION_SIZE_BYTES);
-            if (ptr) sessions.set(id, ptr);
+            if (ptr) myAllocator.hashPut(sessions, id, ptr);
         }
     } 
     // 30% Chance: Logout (Return to Slab -> FILL HOLE)
     else if (r < 0.6) {
-        if (sessions.size > 0) {
-            const keys = Array.from(sessions.keys());
-            const randomKey = keys[Math.floor(Math.random() * keys.length)];
-            const ptr = sessions.get(randomKey);
-            
+        // Random victim picked natively: no key array to build
+        const randomKey = myAllocator.hashSample(sessions);
+        if (randomKey !== undefined) {
+            const ptr = myAllocator.hashDelete(sessions, randomKey);
+
             // O(1) Free (Pushes back to stack)
-            myAllocator.rArenaFree(sessionArena, ptr, SESSION_SIZE_BYTES);
-            sessions.delete(randomKey);
+            myAllocator.rArenaFree(sessionArena, ptr);
         }
     }
     // 40% Chance: Request (Transient Bump)
@@ -62,13 +63,19 @@ for (let i = 0; i < TOTAL_OPS; i++) {
     if (i % 5000 === 0) {
         const rss = process.memoryUsage().rss / 1024 / 1024;
         if (rss > peakRSS) peakRSS = rss;
-        process.stdout.write(`\rOps: ${i} | Sessions: ${sessions.size} | RSS: ${rss.toFixed(2)} MB`);
+        process.stdout.write(`\rOps: ${i} | Sessions: ${myAllocator.hashCount(sessions)} | RSS: ${rss.toFixed(2)} MB`);
     }
 }
 
+const elapsed = performance.now() - start;
 console.log(`\n\n=== RESULTS (ARENA) ===`);
+console.log(`Time:      ${elapsed.toFixed(2)} ms`);
 console.log(`Final RSS: ${(process.memoryUsage().rss / 1024 / 1024).toFixed(2)} MB`);
 console.log(`Peak RSS:  ${peakRSS.toFixed(2)} MB`);
+const slabStats = myAllocator.rArenaStats(sessionArena);
+console.log(`Slab internal fragmentation: ${(slabStats.internalFragmentation * 100).toFixed(1)}%`);
+const tableStats = myAllocator.hashStats(sessions);
+console.log(`Session table: ${tableStats.count} entries, ${tableStats.capacity} slots, ${tableStats.grows} grows, ${(tableStats.bytes / 1024).toFixed(1)} KB`);
 
 // Cleanup
 myAllocator.rDestroy(sessionArena);
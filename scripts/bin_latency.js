@@ -0,0 +1,53 @@
+// Allocation Latency vs Live Block Count
+// Build with PROFILING_MODE 0, otherwise the shadow map dominates the timings.
+const myAllocator = require('./build/Release/my_allocator');
+const { performance } = require('perf_hooks');
+
+// CONFIG
+const CHECKPOINTS = [1000, 10000, 100000, 1000000]; // Live blocks on the heap
+const LIVE_SIZE = 16;    // Small long-lived blocks
+const HOLE_EVERY = 4;    // Free every 4th block to leave small holes behind
+const PROBE_SIZE = 64;   // Does not fit in any hole
+const PROBES = 100000;   // Timed alloc/free pairs per checkpoint
+
+myAllocator.init();
+
+console.log("=== ALLOCATION LATENCY vs LIVE BLOCKS ===");
+console.log(`Live: ${LIVE_SIZE} B blocks, 1 hole every ${HOLE_EVERY}, probe: ${PROBE_SIZE} B\n`);
+
+const results = [];
+let live = 0;
+let allocated = 0;
+
+for (const target of CHECKPOINTS) {
+    // 1. Grow the heap until `target` small blocks are live
+    while (live < target) {
+        const ptr = myAllocator.rAlloc(LIVE_SIZE);
+        if (ptr === 0n) {
+            console.error(`Heap exhausted at ${live} live blocks`);
+            process.exit(1);
+        }
+        allocated++;
+        if (allocated % HOLE_EVERY === 0) {
+            myAllocator.rFree(ptr); // Leave a hole that is too small for the probe
+        } else {
+            live++;
+        }
+    }
+
+    // 2. Time alloc/free pairs that cannot be served by any hole
+    const start = performance.now();
+    for (let i = 0; i < PROBES; i++) {
+        const ptr = myAllocator.rAlloc(PROBE_SIZE);
+        myAllocator.rFree(ptr);
+    }
+    const elapsed = performance.now() - start;
+
+    results.push({
+        'Live Blocks': live,
+        'ns / alloc+free': (elapsed * 1e6 / PROBES).toFixed(1),
+        'Ops/Sec': (PROBES / (elapsed / 1000)).toFixed(0)
+    });
+}
+
+console.table(results);
@@ -0,0 +1,88 @@
+// Bridge Tax: Per-Call vs Batched N-API Crossings
+const myAllocator = require('./build/Release/my_allocator');
+const { performance } = require('perf_hooks');
+
+// CONFIG
+const ROUNDS = 2000;
+const ALLOCS_PER_ROUND = 1000; // Same as the /arena route in server_express.js
+const ITEM_SIZE = 64;
+const LIFETIME = { TRANSIENT: 0, INTERMEDIATE: 1, PERSISTENT: 2 };
+
+myAllocator.init();
+const sizes = new Uint32Array(ALLOCS_PER_ROUND).fill(ITEM_SIZE);
+
+function bench(name, fn) {
+    fn(); // warm up
+    const start = performance.now();
+    for (let r = 0; r < ROUNDS; r++) fn();
+    const elapsed = performance.now() - start;
+    const ops = ROUNDS * ALLOCS_PER_ROUND;
+    return { 'Mode': name, 'Time (ms)': elapsed.toFixed(2), 'Ops/Sec': (ops / (elapsed / 1000)).toFixed(0) };
+}
+
+console.log("=== BRIDGE TAX: PER-CALL vs BATCHED ===");
+console.log(`${ROUNDS} rounds x ${ALLOCS_PER_ROUND} allocations of ${ITEM_SIZE} bytes\n`);
+
+// 1. Transient scratch (bump): allocate, then reset
+const scratch = myAllocator.createArena(128 * 1024, LIFETIME.TRANSIENT);
+const bumpCall = bench('Bump, per-call', () => {
+    for (let i = 0; i < ALLOCS_PER_ROUND; i++) myAllocator.rArena(scratch, ITEM_SIZE);
+    myAllocator.rReset(scratch);
+});
+const bumpBatch = bench('Bump, batched', () => {
+    myAllocator.rArenaBatch(scratch, sizes);
+    myAllocator.rReset(scratch);
+});
+
+// 2. Slab sessions: allocate and free every pointer again
+const slab = myAllocator.createArena(1024 * 1024, LIFETIME.INTERMEDIATE);
+const ptrs = new Array(ALLOCS_PER_ROUND);
+const slabCall = bench('Slab alloc+free, per-call', () => {
+    for (let i = 0; i < ALLOCS_PER_ROUND; i++) ptrs[i] = myAllocator.rArena(slab, ITEM_SIZE);
+    for (let i = 0; i < ALLOCS_PER_ROUND; i++) myAllocator.rArenaFree(slab, ptrs[i]);
+});
+const slabBatch = bench('Slab alloc+free, batched', () => {
+    const batch = myAllocator.rArenaBatch(slab, sizes);
+    myAllocator.rArenaFreeBatch(slab, batch);
+});
+
+// 3. Handle mode: Smi handles instead of BigInt pointers
+const slabH = myAllocator.createArenaH(1024 * 1024, LIFETIME.INTERMEDIATE);
+const handles = new Uint32Array(ALLOCS_PER_ROUND);
+const slabHandle = bench('Slab alloc+free, handles', () => {
+    for (let i = 0; i < ALLOCS_PER_ROUND; i++) handles[i] = myAllocator.rArenaH(slabH, ITEM_SIZE);
+    for (let i = 0; i < ALLOCS_PER_ROUND; i++) myAllocator.rArenaFreeH(slabH, handles[i]);
+});
+
+console.table([bumpCall, bumpBatch, slabCall, slabBatch, slabHandle]);
+console.log(`Bump speedup:   ${(bumpCall['Time (ms)'] / bumpBatch['Time (ms)']).toFixed(2)}x`);
+console.log(`Slab speedup:   ${(slabCall['Time (ms)'] / slabBatch['Time (ms)']).toFixed(2)}x`);
+console.log(`Handle speedup: ${(slabCall['Time (ms)'] / slabHandle['Time (ms)']).toFixed(2)}x`);
+
+// Stale handles are detected instead of corrupting memory
+const stale = myAllocator.rArenaH(slabH, ITEM_SIZE);
+myAllocator.rArenaFreeH(slabH, stale);
+if (!myAllocator.rArenaFreeH(slabH, stale) && myAllocator.rResolve(stale) === 0n) {
+    console.log("✅ Success: Double free through a stale handle was rejected.");
+}
+
+// Handles know what they point at: a block, an arena or an arena slot
+// passed to the call for another kind is refused, not cast
+const blockH = myAllocator.rAllocH(ITEM_SIZE);
+const slotH = myAllocator.rArenaH(slabH, ITEM_SIZE);
+const otherH = myAllocator.createArenaH(64 * 1024, LIFETIME.INTERMEDIATE);
+const mismatches = [
+    myAllocator.rFreeH(slabH), myAllocator.rFreeH(slotH),
+    myAllocator.rArenaH(blockH, ITEM_SIZE) !== 0, myAllocator.rArenaH(slotH, ITEM_SIZE) !== 0,
+    myAllocator.rArenaFreeH(slabH, blockH), myAllocator.rArenaFreeH(otherH, slotH),
+    myAllocator.rArenaFreeH(blockH, slotH),
+    myAllocator.rResetH(blockH), myAllocator.rResetH(slotH), myAllocator.rDestroyH(slotH)
+];
+if (mismatches.every((accepted) => !accepted) && myAllocator.rArenaFreeH(slabH, slotH) &&
+    myAllocator.rFreeH(blockH) && myAllocator.rDestroyH(otherH)) {
+    console.log("✅ Success: Handles of the wrong kind were refused, and the right calls still worked.");
+}
+myAllocator.rDestroyH(slabH);
+
+myAllocator.rDestroy(scratch);
+myAllocator.rDestroy(slab);
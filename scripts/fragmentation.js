@@ -0,0 +1,75 @@
+// Fragmentation Under Session Churn
+// Build with PROFILING_MODE 0 to keep the shadow map out of the picture.
+const myAllocator = require('./build/Release/my_allocator');
+
+// CONFIG
+const TOTAL_OPS = 2000000;
+const MAX_LIVE = 20000;
+const SIZES = [24, 40, 64, 96, 200, 512, 1500]; // Mixed session payloads
+const BIG_PROBE = 256 * 1024;                   // Needs contiguous memory
+
+myAllocator.init();
+
+const live = [];
+let failed = 0;
+let bigFailed = 0;
+
+console.log("=== FRAGMENTATION UNDER CHURN ===");
+
+for (let i = 0; i < TOTAL_OPS; i++) {
+    // Allocate while below the cap, otherwise free a random victim
+    if (live.length < MAX_LIVE && Math.random() < 0.55) {
+        const size = SIZES[Math.floor(Math.random() * SIZES.length)];
+        const ptr = myAllocator.rAlloc(size);
+        if (ptr === 0n) failed++;
+        else live.push(ptr);
+    } else if (live.length > 0) {
+        const victim = Math.floor(Math.random() * live.length);
+        myAllocator.rFree(live[victim]);
+        live[victim] = live[live.length - 1];
+        live.pop();
+    }
+
+    // Every so often, ask for one large contiguous block
+    if (i % 10000 === 0) {
+        const big = myAllocator.rAlloc(BIG_PROBE);
+        if (big === 0n) bigFailed++;
+        else myAllocator.rFree(big);
+    }
+
+    if (i % 100000 === 0) {
+        const frag = myAllocator.rFragmentation ? myAllocator.rFragmentation().toFixed(4) : 'n/a';
+        process.stdout.write(`\rOps: ${i} | Live: ${live.length} | Fragmentation: ${frag}`);
+    }
+}
+
+const frag = myAllocator.rFragmentation();
+
+// The load drops: keep 1 block in 64. The survivors pin their pages, so
+// the heap keeps its peak RSS until rTrim hands the free pages back.
+// rTrim moves nothing, so the fragmentation ratio stays as it is.
+let kept = 0;
+live.forEach((ptr, i) => {
+    if (i % 64 === 0) live[kept++] = ptr;
+    else myAllocator.rFree(ptr);
+});
+live.length = kept;
+const drainedFrag = myAllocator.rFragmentation();
+const rssBefore = process.memoryUsage().rss;
+const released = myAllocator.rTrim();
+const rssAfter = process.memoryUsage().rss;
+const trimmedFrag = myAllocator.rFragmentation();
+const MB = 1024 * 1024;
+
+console.log(`\n\n=== RESULTS ===`);
+console.log(`Failed small allocs:  ${failed}`);
+console.log(`Failed ${BIG_PROBE / 1024} KB allocs: ${bigFailed}`);
+console.log(`Fragmentation:        ${frag.toFixed(4)} under churn, ${drainedFrag.toFixed(4)} after the drain, ${trimmedFrag.toFixed(4)} after rTrim`);
+console.log(`rTrim:                ${(released / MB).toFixed(2)} MB released, RSS ${(rssBefore / MB).toFixed(2)} -> ${(rssAfter / MB).toFixed(2)} MB`);
+live.forEach((ptr) => myAllocator.rFree(ptr));
+if (rssAfter < rssBefore && trimmedFrag === drainedFrag) {
+    console.log("✅ Success: rTrim lowered RSS and left fragmentation unchanged.");
+} else {
+    console.log("❌ rTrim did not lower RSS.");
+    process.exitCode = 1;
+}
@@ -0,0 +1,127 @@
+// Trained vs untrained lifetime routing on a mixed-lifetime workload.
+// 1. Train (build with PROFILING_MODE 1):
+//      R_ALLOC_SAMPLE_RATE=100 node policy_benchmark.js --run && node train_policy.js
+// 2. Compare (build with PROFILING_MODE 0):
+//      node policy_benchmark.js [policy.csv]
+const { execFileSync } = require('child_process');
+const { performance } = require('perf_hooks');
+const fs = require('fs');
+const path = require('path');
+
+// CONFIG
+const OPS = 500000;
+const MAX_SESSIONS = 50000;
+const MAX_CACHE = 100000;
+const RUNS = 3;           // children per mode
+const SITE_REQUEST = 1;  // freed before the next op
+const SITE_SESSION = 2;  // random logout
+const SITE_CACHE = 3;    // never freed
+
+// Seeded, so both runs see the same sequence of sizes and frees
+let seed = 42;
+function random() {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    return seed / 0x7fffffff;
+}
+
+function runWorkload() {
+    const myAllocator = require('./build/Release/my_allocator');
+    myAllocator.init();
+
+    const sessions = [];
+    const cache = [];
+    let peakRSS = 0;
+
+    const start = performance.now();
+    for (let i = 0; i < OPS; i++) {
+        // Request scratch: a few buffers, gone by the end of the request
+        const a = myAllocator.rAlloc(256 + Math.floor(random() * 1792), SITE_REQUEST);
+        const b = myAllocator.rAlloc(64 + Math.floor(random() * 448), SITE_REQUEST);
+
+        // Sessions come and go at random
+        if (sessions.length < MAX_SESSIONS || random() < 0.5) {
+            const session = myAllocator.rAlloc(160 + Math.floor(random() * 32), SITE_SESSION);
+            if (sessions.length < MAX_SESSIONS) {
+                sessions.push(session);
+            } else {
+                const slot = Math.floor(random() * MAX_SESSIONS);
+                myAllocator.rFree(sessions[slot]);
+                sessions[slot] = session;
+            }
+        }
+
+        // The cache only ever grows
+        if (i % 5 === 0 && cache.length < MAX_CACHE) {
+            cache.push(myAllocator.rAlloc(300 + Math.floor(random() * 100), SITE_CACHE));
+        }
+
+        myAllocator.rFree(b);
+        myAllocator.rFree(a);
+
+        if (i % 10000 === 0) {
+            const rss = process.memoryUsage().rss;
+            if (rss > peakRSS) peakRSS = rss;
+        }
+    }
+    const elapsed = performance.now() - start;
+    myAllocator.flushProfile(); // training builds: log the cache as still alive
+
+    // Traffic is over: every session logs out, only the cache stays
+    const fragDuring = myAllocator.rFragmentation();
+    for (const session of sessions) myAllocator.rFree(session);
+
+    const fragAfter = myAllocator.rFragmentation();
+
+    // Whatever rTrim cannot hand back is stuck between cache entries
+    myAllocator.rTrim();
+    return {
+        opsPerSec: Math.round(OPS / (elapsed / 1000)),
+        fragDuring,
+        fragAfter,
+        peakRSS: peakRSS / 1024 / 1024,
+        trimRSS: process.memoryUsage().rss / 1024 / 1024,
+    };
+}
+
+if (process.argv[2] === '--run') {
+    console.log(JSON.stringify(runWorkload()));
+    return;
+}
+
+const policyPath = path.resolve(process.argv[2] || 'policy.csv');
+if (!fs.existsSync(policyPath)) {
+    console.error(`No policy at ${policyPath}, train one first (see the top of this file).`);
+    process.exit(1);
+}
+
+function child(env) {
+    const out = execFileSync(process.execPath, [__filename, '--run'], {
+        cwd: __dirname,
+        env: { ...process.env, ...env },
+    }).toString().split('\n');
+    return JSON.parse(out.find((line) => line.startsWith('{')));
+}
+
+// Alternate the two modes and keep each one's best run, so one noisy
+// child does not decide the throughput comparison
+function best(runs) {
+    return runs.reduce((a, b) => (b.opsPerSec > a.opsPerSec ? b : a));
+}
+const untrainedRuns = [];
+const trainedRuns = [];
+for (let r = 0; r < RUNS; r++) {
+    untrainedRuns.push(child({ R_ALLOC_POLICY: '' }));
+    trainedRuns.push(child({ R_ALLOC_POLICY: policyPath }));
+}
+const untrained = best(untrainedRuns);
+const trained = best(trainedRuns);
+
+const row = (r) => ({
+    'Ops/sec': r.opsPerSec,
+    'Frag (traffic)': r.fragDuring.toFixed(3),
+    'Frag (after logout)': r.fragAfter.toFixed(3),
+    'Peak RSS (MB)': r.peakRSS.toFixed(2),
+    'RSS after trim (MB)': r.trimRSS.toFixed(2),
+});
+console.table({ Untrained: row(untrained), Trained: row(trained) });
+console.log(`Throughput: ${(trained.opsPerSec / untrained.opsPerSec).toFixed(2)}x`);
@@ -0,0 +1,80 @@
+// Growable Heap Testing
+const myAllocator = require('./build/Release/my_allocator');
+
+const MB = 1024 * 1024;
+const SEGMENT_SIZE = 4 * MB;
+const MAX_HEAP = 64 * MB;
+
+// Child run: init() with a segment size only, in a fresh process
+if (process.argv[2] === '--default-cap') {
+    let rejected = false;
+    try { myAllocator.init(0); } catch (e) { rejected = e instanceof RangeError; }
+    myAllocator.init(SEGMENT_SIZE);
+    const blocks = [];
+    for (let i = 0; i < 48; i++) blocks.push(myAllocator.rAlloc(256 * 1024)); // 12MB
+    const stats = myAllocator.rStats();
+    console.log(JSON.stringify({ rejected, allocated: blocks.filter(p => p !== 0n).length,
+                                 segments: stats.segments, maxBytes: stats.maxBytes }));
+    return;
+}
+
+console.log("--- Initializing Heap (4MB segments, 64MB cap) ---");
+myAllocator.init(SEGMENT_SIZE, MAX_HEAP);
+const rssMB = () => (process.memoryUsage().rss / MB).toFixed(2);
+console.log(`RSS: ${rssMB()} MB`);
+
+// 1. Fill well past one segment with 64KB blocks
+console.log("\n--- Growing Past the First Segment ---");
+const blocks = [];
+for (let i = 0; i < 256; i++) {
+    const ptr = myAllocator.rAlloc(64 * 1024);
+    if (ptr === 0n) break;
+    blocks.push(ptr);
+}
+console.log(`Allocated ${blocks.length} x 64KB = ${(blocks.length / 16).toFixed(1)} MB`);
+if (blocks.length === 256) {
+    console.log("✅ Success: Heap grew beyond a single segment.");
+}
+
+// 2. The hard cap must still be respected
+console.log("\n--- Hitting the Hard Cap ---");
+const capped = [];
+for (;;) {
+    const ptr = myAllocator.rAlloc(1 * MB);
+    if (ptr === 0n) break;
+    capped.push(ptr);
+}
+console.log(`Extra 1MB blocks before NULL: ${capped.length}`);
+if (capped.length < MAX_HEAP / MB) {
+    console.log("✅ Success: rAlloc returned NULL at the cap.");
+}
+
+// 3. An arena bigger than a segment gets a segment of its own
+console.log("\n--- Arena Larger Than a Segment ---");
+capped.forEach(p => myAllocator.rFree(p));
+const arena = myAllocator.createArena(6 * MB, 2);
+const a1 = myAllocator.rArena(arena, 5 * MB);
+console.log(`Arena: 0x${arena.toString(16)} | 5MB alloc: 0x${a1.toString(16)}`);
+if (arena !== 0n && a1 !== 0n) {
+    console.log("✅ Success: Arena spans more than one default segment.");
+}
+myAllocator.rDestroy(arena);
+
+// 4. Free everything, empty segments must be unmapped again
+console.log("\n--- Releasing Everything ---");
+blocks.forEach(p => myAllocator.rFree(p));
+console.log(`RSS: ${rssMB()} MB`);
+const again = myAllocator.rAlloc(64 * 1024);
+if (again !== 0n) {
+    console.log("✅ Success: Heap still usable after segments were unmapped.");
+}
+
+// 5. init(segmentSize) without a cap keeps the default one, and a zero segment
+// size is refused instead of leaving a broken heap
+console.log("\n--- Segment Size Without a Cap ---");
+const child = JSON.parse(require('child_process').execFileSync(process.execPath, [__filename, '--default-cap'],
+                                                                { cwd: __dirname }).toString().trim().split('\n').pop());
+console.log(`init(0) rejected: ${child.rejected} | ${child.allocated}/48 x 256KB in ${child.segments} segments, cap ${child.maxBytes / MB} MB`);
+if (child.rejected && child.allocated === 48 && child.segments > 1 && child.maxBytes === 1024 * MB) {
+    console.log("✅ Success: The heap grew past one segment under the default cap.");
+}
@@ -7,6 +7,7 @@ const TOTAL_REQUESTS = 100000;  // Total traffic to simulate
 const CONCURRENT_USERS = 100;   // Active sessions at any time
 const SESSION_SIZE = 64;        // Size of a User Session object (Slab)
 const REQUEST_TEMP_SIZE = 1024; // Temp data per request (Bump)
+const REQUEST_ARENA_SIZE = 4096; // Scratchpad each request gets from the arena pool
 
 // LIFETIME ENUMS
 const LIFETIME = {
@@ -36,8 +37,12 @@ try {
     // Create one large INTERMEDIATE arena to hold all user sessions (Slabs)
     // 1MB should be enough for our test
     sessionArena = myAllocator.createArena(1024 * 1024, LIFETIME.INTERMEDIATE);
+    // Park a few request scratchpads up front, so even the first requests
+    // reuse an arena instead of creating one
+    myAllocator.prewarmArenas(LIFETIME.TRANSIENT, REQUEST_ARENA_SIZE, 8);
     console.log("✅ Server Heap Initialized.");
-    console.log("✅ Session Store (Slab Allocator) Ready.\n");
+    console.log("✅ Session Store (Slab Allocator) Ready.");
+    console.log("✅ Request Arena Pool Warmed.\n");
 } catch (e) {
     console.error("❌ Initialization Failed:", e);
     process.exit(1);
@@ -68,7 +73,7 @@ function destroySession(userId) {
     if (!ptr) return;
 
     // Return the block to the Slab Allocator (Recycle!)
-    myAllocator.rArenaFree(sessionArena, ptr, SESSION_SIZE);
+    myAllocator.rArenaFree(sessionArena, ptr);
     
     activeSessions.delete(userId);
 }
@@ -76,8 +81,8 @@ function destroySession(userId) {
 // Simulate an HTTP Request (Bump Alloc)
 function handleRequest(userId) {
     // 1. Setup Request Scope (Transient Arena)
-    // Every request gets a fresh scratchpad.
-    const reqArena = myAllocator.createArena(4096, LIFETIME.TRANSIENT);
+    // Every request gets a fresh scratchpad, reused from the arena pool.
+    const reqArena = myAllocator.acquireArena(LIFETIME.TRANSIENT, REQUEST_ARENA_SIZE);
     
     // 2. Simulate Work (Allocating temp strings, JSON, etc.)
     // We allocate 10 small chunks
@@ -94,8 +99,8 @@ function handleRequest(userId) {
     }
 
     // 4. Cleanup (Bulk Free)
-    // Destroy the entire request scratchpad in O(1)
-    myAllocator.rDestroy(reqArena);
+    // Reset the entire request scratchpad in O(1) and park it for the next request
+    myAllocator.releaseArena(reqArena);
 }
 
 // ==========================================
@@ -138,6 +143,8 @@ console.log(`Time:        ${(end - start).toFixed(2)} ms`);
 console.log(`Throughput:  ${(TOTAL_REQUESTS / ((end - start)/1000)).toFixed(0)} req/sec`);
 console.log(`Peak Users:  ${peakSessions}`);
 console.log(`Final Heap:  ${(process.memoryUsage().rss / 1024 / 1024).toFixed(2)} MB`);
+const pool = myAllocator.arenaPoolStats();
+console.log(`Arena Pool:  ${pool.hits} reused, ${pool.misses} created, ${pool.parked} parked`);
 
 // Cleanup Global Session Arena
 myAllocator.rDestroy(sessionArena);
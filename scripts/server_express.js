@@ -10,11 +10,14 @@ const PORT = 3000;
 const ALLOCS_PER_REQ = 1000; // Simulate "heavy work" (1000 allocations per user)
 const ITEM_SIZE = 64;        // 64 bytes per item
 const LIFETIME_TRANSIENT = 0;
+const ARENA_SIZE = 128 * 1024; // Scratchpad per request, plenty for our test
 
 // Initialize your Heap (64MB)
 try {
     myAllocator.init(); 
     console.log("✅ Custom Allocator Initialized (64MB Heap)");
+    // Enough parked scratchpads for a burst of concurrent requests
+    myAllocator.prewarmArenas(LIFETIME_TRANSIENT, ARENA_SIZE, 16);
 } catch (e) {
     console.error("Failed to init allocator:", e);
     process.exit(1);
@@ -24,15 +27,14 @@ try {
 // MIDDLEWARE: The "Arena Lifecycle" Manager
 // =========================================================
 const arenaMiddleware = (req, res, next) => {
-    // 1. Create a fresh Arena for this request (Scratchpad)
-    // We give it 128KB, plenty for our test
-    req.arena = myAllocator.createArena(128 * 1024, LIFETIME_TRANSIENT);
+    // 1. Take a reset Arena from the pool for this request (Scratchpad)
+    req.arena = myAllocator.acquireArena(LIFETIME_TRANSIENT, ARENA_SIZE);
 
     // 2. Hook into the 'finish' event to clean up
     res.on('finish', () => {
-        // AUTOMATIC CLEANUP: The request is done, destroy the arena.
-        // This is O(1) bulk free. No GC pause.
-        myAllocator.rDestroy(req.arena);
+        // AUTOMATIC CLEANUP: The request is done, reset the arena and park it.
+        // This is O(1) bulk free. No GC pause, no heap scan for the next one.
+        myAllocator.releaseArena(req.arena);
     });
 
     next();
@@ -52,6 +54,18 @@ app.get('/arena', arenaMiddleware, (req, res) => {
     res.send('Arena Work Done');
 });
 
+// =========================================================
+// ROUTE 1b: The "Arena Batch" Endpoint (One Native Crossing)
+// =========================================================
+const BATCH_SIZES = new Uint32Array(ALLOCS_PER_REQ).fill(ITEM_SIZE);
+
+app.get('/arena-batch', arenaMiddleware, (req, res) => {
+    // Same work as /arena, but all 1000 allocations cross the bridge once
+    myAllocator.rArenaBatch(req.arena, BATCH_SIZES);
+
+    res.send('Arena Batch Work Done');
+});
+
 // =========================================================
 // ROUTE 2: The "Native" Endpoint (Standard V8 GC)
 // =========================================================
@@ -71,5 +85,6 @@ app.get('/native', (req, res) => {
 app.listen(PORT, () => {
     console.log(`🚀 Hybrid Server running on http://localhost:${PORT}`);
     console.log(`   /arena  -> Uses Custom C Allocator`);
+    console.log(`   /arena-batch -> Same work, one batched native call`);
     console.log(`   /native -> Uses V8 Garbage Collector`);
 });
\ No newline at end of file
@@ -57,4 +57,404 @@ console.log(`A4 (Still working): 0x${aPtr4.toString(16)}`);
 
 if (aPtr4 !== 0n) {
     console.log("✅ Success: Arena A survived Arena B's destruction.");
-}
\ No newline at end of file
+}
+
+// 9. Growth: Arena A has 512 bytes, but should chain new chunks on demand
+console.log("\n--- Growing Arena A Past Its Capacity ---");
+const grown = [];
+for (let i = 0; i < 64; i++) {
+    grown.push(myAllocator.rArena(arenaA, 64));
+}
+if (grown.every(p => p !== 0n)) {
+    console.log("✅ Success: Arena A grew past its initial 512 bytes.");
+}
+
+// 10. Growth limit: Arena C may never hold more than 1KB in total
+const arenaC = myAllocator.createArena(256, LIFETIME.PERSISTENT, 1024);
+let served = 0;
+while (myAllocator.rArena(arenaC, 64) !== 0n) served++;
+console.log(`Arena C served ${served} x 64 bytes before hitting its 1KB maximum`);
+if (served === 16) {
+    console.log("✅ Success: Arena C respected its maximum.");
+}
+
+// 11. Reset keeps only the first chunk
+myAllocator.rReset(arenaA);
+const aPtr5 = myAllocator.rArena(arenaA, 64);
+if (aPtr5 === aPtr1) {
+    console.log("✅ Success: Arena A reset back to its first chunk.");
+}
+// 12. Checkpoints: nested phases drop their scratch memory
+console.log("\n--- Mark / Rewind on Arena A ---");
+const parseMark = myAllocator.rArenaMark(arenaA);
+myAllocator.rArena(arenaA, 256);                // parse scratch
+const renderMark = myAllocator.rArenaMark(arenaA);
+for (let i = 0; i < 32; i++) {
+    myAllocator.rArena(arenaA, 128);            // render scratch (chains chunks)
+}
+myAllocator.rArenaRewind(arenaA, renderMark);
+const afterRender = myAllocator.rArena(arenaA, 64);
+myAllocator.rArenaRewind(arenaA, parseMark);
+const afterParse = myAllocator.rArena(arenaA, 64);
+if (afterRender === renderMark.current && afterParse === parseMark.current) {
+    console.log("✅ Success: Rewind restored both checkpoints.");
+}
+if (!myAllocator.rArenaRewind(arenaA, renderMark)) {
+    console.log("✅ Success: Stale mark was rejected.");
+}
+// A reset ends every mark's epoch, even once more is in use than at mark time
+const resetMark = myAllocator.rArenaMark(arenaA);
+myAllocator.rReset(arenaA);
+myAllocator.rArena(arenaA, resetMark.size + 16); // first region, past the mark
+if (!myAllocator.rArenaRewind(arenaA, resetMark) && myAllocator.rArenaMark(arenaA).epoch > resetMark.epoch) {
+    console.log("✅ Success: Mark from before a reset was rejected.");
+}
+// 13. Slab frees need no size, and foreign pointers are refused
+console.log("\n--- Size-less Free on a Slab Arena ---");
+const slabA = myAllocator.createArena(1024, LIFETIME.INTERMEDIATE);
+const slabB = myAllocator.createArena(1024, LIFETIME.INTERMEDIATE);
+const s1 = myAllocator.rArena(slabA, 100);
+myAllocator.rArenaFree(slabA, s1);
+if (myAllocator.rArena(slabA, 100) === s1) {
+    console.log("✅ Success: Freed slot was reused without passing its size.");
+}
+const foreign = myAllocator.rArena(slabB, 100);
+if (!myAllocator.rArenaFree(slabA, foreign) && !myAllocator.rArenaFree(slabA, s1 + 8n)) {
+    console.log("✅ Success: Foreign and interior pointers were rejected.");
+}
+// The next slot of s1's run (100 bytes use the 112B class) is carved, slot
+// aligned and owned by slabA, but nobody was given it
+if (!myAllocator.rArenaFree(slabA, s1 + 112n) && myAllocator.rArena(slabA, 100) === s1 + 112n) {
+    console.log("✅ Success: A never-issued slot was rejected and later issued normally.");
+}
+myAllocator.rDestroy(slabA);
+myAllocator.rDestroy(slabB);
+
+// 14. Stats: counters follow allocations and frees
+console.log("\n--- Heap and Arena Stats ---");
+const before = myAllocator.rStats();
+const big = myAllocator.rAlloc(64 * 1024);
+const during = myAllocator.rStats();
+myAllocator.rFree(big);
+const after = myAllocator.rStats();
+console.log(`Heap: ${during.usedBytes} used, peak ${during.peakUsedBytes}, ${during.freeBlocks} free blocks, largest ${during.largestFreeBlock}`);
+if (during.usedBytes - before.usedBytes === 64 * 1024 && after.usedBytes === before.usedBytes &&
+    during.peakUsedBytes >= during.usedBytes) {
+    console.log("✅ Success: Heap usage and high-water mark tracked the allocation.");
+}
+const slabC = myAllocator.createArena(1024, LIFETIME.INTERMEDIATE);
+const slots = [];
+for (let i = 0; i < 10; i++) slots.push(myAllocator.rArena(slabC, 48));
+myAllocator.rArenaFree(slabC, slots[0]);
+const slab48 = myAllocator.rArenaStats(slabC).slabs.find((slab) => slab.size === 48);
+console.log(`Slab 48B: ${slab48.runs} run, ${slab48.carved} carved, ${slab48.allocated} allocated, ${slab48.free} free`);
+if (slab48.allocated === 9 && slab48.carved === slab48.allocated + slab48.free) {
+    console.log("✅ Success: Slab class counters match the allocations.");
+}
+const arenaStats = myAllocator.rArenaStats(arenaA);
+if (arenaStats.chunks === 1 && arenaStats.peakUsedBytes > 512 && arenaStats.slabs === undefined) {
+    console.log("✅ Success: Arena A reports its chunks and high-water mark.");
+}
+myAllocator.rDestroy(slabC);
+
+// 15. Aligned allocations
+console.log("\n--- Aligned Allocations ---");
+const defaults = [1, 24, 100, 2000].map((size) => myAllocator.rAlloc(size));
+if (defaults.every((ptr) => ptr % 16n === 0n)) {
+    console.log("✅ Success: rAlloc returns 16-byte aligned blocks.");
+}
+let heapAligned = true;
+for (const align of [32, 64, 256, 4096]) {
+    const ptr = myAllocator.rAllocAligned(100, align);
+    heapAligned = heapAligned && ptr !== 0n && ptr % BigInt(align) === 0n;
+    myAllocator.rFree(ptr);
+}
+if (heapAligned && myAllocator.rAllocAligned(100, 48) === 0n && myAllocator.rAllocAligned(100, 8192) === 0n) {
+    console.log("✅ Success: rAllocAligned honours power-of-two alignments up to 4096.");
+}
+defaults.forEach((ptr) => myAllocator.rFree(ptr));
+let arenaAligned = true;
+for (const policy of [LIFETIME.TRANSIENT, LIFETIME.INTERMEDIATE, LIFETIME.PERSISTENT]) {
+    const arena = myAllocator.createArena(4096, policy);
+    myAllocator.rArena(arena, 8);
+    for (const align of [32, 64, 1024]) {
+        const ptr = myAllocator.rArenaAligned(arena, 40, align);
+        arenaAligned = arenaAligned && ptr !== 0n && ptr % BigInt(align) === 0n;
+    }
+    myAllocator.rDestroy(arena);
+}
+if (arenaAligned) {
+    console.log("✅ Success: rArenaAligned works for every arena policy.");
+}
+const padded = myAllocator.createArena(4096, LIFETIME.TRANSIENT, 0, 1); // ARENA_CACHE_ALIGN
+const c1 = myAllocator.rArena(padded, 8);
+const c2 = myAllocator.rArena(padded, 8);
+if (c1 % 64n === 0n && c2 - c1 === 64n) {
+    console.log("✅ Success: Cache-aligned arena gave each counter its own line.");
+}
+myAllocator.rDestroy(padded);
+
+// 16. Large objects: their own mapping, unmapped again on free
+console.log("\n--- Large Objects ---");
+const threshold = myAllocator.setLargeThreshold(1024 * 1024);
+const heapBefore = myAllocator.rStats();
+const huge = myAllocator.rAllocAligned(3 * 1024 * 1024, 4096);
+const bigStats = myAllocator.rStats();
+if (huge !== 0n && huge % 4096n === 0n && bigStats.largeObjects === heapBefore.largeObjects + 1 &&
+    bigStats.segments === heapBefore.segments) {
+    console.log("✅ Success: 3MB block mapped on its own, no segment split.");
+}
+myAllocator.rFree(huge);
+if (myAllocator.rStats().mappedBytes === heapBefore.mappedBytes) {
+    console.log("✅ Success: Freeing it unmapped the whole mapping.");
+}
+const slabArena = myAllocator.createArena(64 * 1024, LIFETIME.INTERMEDIATE);
+const bigSlot = myAllocator.rArena(slabArena, 100000);
+const slabStats = myAllocator.rArenaStats(slabArena);
+if (bigSlot !== 0n && slabStats.largeObjects === 1 && myAllocator.rArenaFree(slabArena, bigSlot) &&
+    !myAllocator.rArenaFree(slabArena, bigSlot) && myAllocator.rArenaStats(slabArena).largeObjects === 0) {
+    console.log("✅ Success: Slab arena served and freed a 100KB request.");
+}
+myAllocator.rArena(slabArena, 2 * 1024 * 1024);
+myAllocator.rReset(slabArena);
+if (myAllocator.rArenaStats(slabArena).largeObjects === 0) {
+    console.log("✅ Success: rReset released the arena's large objects.");
+}
+myAllocator.rDestroy(slabArena);
+myAllocator.setLargeThreshold(threshold);
+
+// 17. Size classes: about four per doubling, so odd sizes waste little
+console.log("\n--- Slab Size Classes ---");
+const classArena = myAllocator.createArena(64 * 1024, LIFETIME.INTERMEDIATE);
+[65, 65, 2049].forEach((size) => myAllocator.rArena(classArena, size));
+const classStats = myAllocator.rArenaStats(classArena);
+const classOf = (size) => classStats.slabs.find((slab) => slab.requestedBytes % size === 0 && slab.requests > 0).size;
+console.log(`65B -> ${classOf(65)}B slot, 2049B -> ${classOf(2049)}B slot, internal fragmentation ${classStats.internalFragmentation.toFixed(3)}`);
+if (classOf(65) === 80 && classOf(2049) === 2560 && classStats.internalFragmentation < 0.25) {
+    console.log("✅ Success: Odd sizes land in the next 16B / quarter-doubling class.");
+}
+myAllocator.rDestroy(classArena);
+
+// 18. Empty slab runs leave their class, and other classes reuse them
+console.log("\n--- Returning Empty Slab Runs ---");
+const runArena = myAllocator.createArena(64 * 1024, LIFETIME.INTERMEDIATE);
+const spike = [];
+for (let i = 0; i < 2000; i++) spike.push(myAllocator.rArena(runArena, 128));
+const atPeak = myAllocator.rArenaStats(runArena);
+spike.forEach((ptr) => myAllocator.rArenaFree(runArena, ptr));
+const drained = myAllocator.rArenaStats(runArena);
+const run128 = drained.slabs.find((slab) => slab.size === 128);
+console.log(`128B class: ${atPeak.usedBytes} -> ${drained.usedBytes} bytes used, ${run128.runs} run kept, ${drained.pooledRuns} pooled`);
+// The current run stays, plus at most one pinned by the class's recent frees;
+// spike[1000] sat in a middle run, which is now pooled
+if (run128.runs <= 2 && drained.pooledRuns > 0 && drained.usedBytes < atPeak.usedBytes &&
+    !myAllocator.rArenaFree(runArena, spike[1000])) {
+    console.log("✅ Success: Empty runs went back to the pool after the spike.");
+}
+for (let i = 0; i < 500; i++) myAllocator.rArena(runArena, 256);
+const reused = myAllocator.rArenaStats(runArena);
+if (reused.reservedBytes === drained.reservedBytes && reused.pooledRuns < drained.pooledRuns) {
+    console.log("✅ Success: The 256B class took pooled runs instead of growing the arena.");
+}
+myAllocator.rDestroy(runArena);
+
+// 19. Bitmap runs: slots go out lowest address first, and a slot can only
+// come back once
+console.log("\n--- Bitmap Slab Runs ---");
+const bitArena = myAllocator.createArena(64 * 1024, LIFETIME.INTERMEDIATE);
+const pages = [];
+for (let i = 0; i < 4; i++) pages.push(myAllocator.rArena(bitArena, 4096));
+const bitRun = myAllocator.rArenaStats(bitArena).slabs.find((slab) => slab.size === 4096);
+console.log(`4096B class: ${bitRun.carved} slots in the run, ${bitRun.allocated} allocated`);
+if (pages.every((ptr, i) => ptr === pages[0] + BigInt(i * 4096)) && bitRun.allocated === 4) {
+    console.log("✅ Success: Consecutive requests got consecutive slots.");
+}
+myAllocator.rDestroy(bitArena);
+// A fresh arena, so the first free lands in the class's empty recent list:
+// that free is checked too, not only the ones that reach the bitmap
+const freshArena = myAllocator.createArena(64 * 1024, LIFETIME.INTERMEDIATE);
+const freshSlot = myAllocator.rArena(freshArena, 64);
+const freshNext = myAllocator.rArena(freshArena, 64);
+if (myAllocator.rArenaFree(freshArena, freshSlot) && !myAllocator.rArenaFree(freshArena, freshSlot) &&
+    myAllocator.rArena(freshArena, 64) === freshSlot && myAllocator.rArena(freshArena, 64) !== freshSlot) {
+    console.log("✅ Success: A second free of the same slot was refused, and the slot was issued once.");
+}
+// Slot 5 of the run was carved but never handed out
+if (!myAllocator.rArenaFree(freshArena, freshNext + 4n * 64n)) {
+    console.log("✅ Success: A slot that was never handed out was refused.");
+}
+myAllocator.rDestroy(freshArena);
+
+// 20. Arena pool: released arenas come back reset, instead of being rebuilt
+console.log("\n--- Arena Pool ---");
+const warmed = myAllocator.prewarmArenas(LIFETIME.TRANSIENT, 3000, 2);
+const poolBefore = myAllocator.arenaPoolStats();
+const pooled = myAllocator.acquireArena(LIFETIME.TRANSIENT, 3000);
+for (let i = 0; i < 8; i++) myAllocator.rArena(pooled, 1024); // chains a chunk
+myAllocator.releaseArena(pooled);
+const again = myAllocator.acquireArena(LIFETIME.TRANSIENT, 4096);
+const againStats = myAllocator.rArenaStats(again);
+const poolAfter = myAllocator.arenaPoolStats();
+console.log(`Warmed ${warmed}, ${poolAfter.hits - poolBefore.hits} hits, capacity ${againStats.capacity}, ${againStats.chunks} chunk`);
+if (warmed === 2 && again === pooled && againStats.capacity === 4096 && againStats.usedBytes === 0 &&
+    againStats.peakUsedBytes === 0 && againStats.chunks === 1 && poolAfter.misses === poolBefore.misses) {
+    console.log("✅ Success: Released arena came back reset, without creating a new one.");
+}
+myAllocator.releaseArena(again);
+const slabPooled = myAllocator.acquireArena(LIFETIME.INTERMEDIATE, 64 * 1024);
+const oldSlot = myAllocator.rArena(slabPooled, 128);
+myAllocator.releaseArena(slabPooled);
+const slabAgain = myAllocator.acquireArena(LIFETIME.INTERMEDIATE, 64 * 1024);
+if (slabAgain === slabPooled && !myAllocator.rArenaFree(slabAgain, oldSlot)) {
+    console.log("✅ Success: A slot from before the release was refused.");
+}
+myAllocator.releaseArena(slabAgain);
+myAllocator.setArenaPoolLimit(1);
+const limited = myAllocator.arenaPoolStats();
+const extraArenas = [0, 1].map(() => myAllocator.acquireArena(LIFETIME.PERSISTENT, 1024));
+extraArenas.forEach((arena) => myAllocator.releaseArena(arena));
+const overLimit = myAllocator.arenaPoolStats();
+if (overLimit.dropped === limited.dropped + 1 && overLimit.parked <= 3) {
+    console.log("✅ Success: The pool kept one arena per bucket and destroyed the rest.");
+}
+myAllocator.setArenaPoolLimit(32);
+// A slab arena too small for a run in its first region is not parked, and
+// parkedBytes counts a parked arena's header as well as its first region
+const smallPool = myAllocator.arenaPoolStats();
+myAllocator.releaseArena(myAllocator.acquireArena(LIFETIME.INTERMEDIATE, 4096));
+myAllocator.releaseArena(myAllocator.acquireArena(LIFETIME.TRANSIENT, 1 << 20));
+const smallPoolAfter = myAllocator.arenaPoolStats();
+const perArena = (smallPoolAfter.parkedBytes - smallPool.parkedBytes) / (smallPoolAfter.parked - smallPool.parked);
+if (smallPoolAfter.parked === smallPool.parked + 1 && perArena > (1 << 20)) {
+    console.log("✅ Success: Only the 1MB arena was parked, header included in parkedBytes.");
+}
+
+// 21. Off-heap structs: fixed-shape records in an arena, read through typed arrays
+console.log("\n--- Off-heap Structs ---");
+const Session = myAllocator.defineStruct({ id: "u64", flags: "u32", loginTime: "f64", hits: "u32" });
+console.log(`Session: ${Session.size} bytes, loginTime at ${Session.fields.loginTime.offset}, flags at ${Session.fields.flags.offset}`);
+if (Session.size === 24 && Session.align === 8 && Session.fields.id.offset === 0 &&
+    Session.fields.loginTime.offset === 8 && Session.fields.flags.offset === 16 && Session.fields.hits.offset === 20) {
+    console.log("✅ Success: Fields were packed largest first, with no padding.");
+}
+const structArena = myAllocator.createArena(64 * 1024, LIFETIME.INTERMEDIATE);
+const sessions = myAllocator.createStructTable(structArena, Session, 4, "aos");
+const soaSessions = myAllocator.createStructTable(structArena, Session, 4, "soa");
+const rowA = myAllocator.structAlloc(sessions.ptr);
+const record = new sessions.Record(rowA);
+record.id = 42n;
+record.loginTime = 1700000000.5;
+record.hits++;
+record.hits++;
+if (record.id === 42n && record.loginTime === 1700000000.5 && record.hits === 2 &&
+    sessions.fields.hits.array[rowA * sessions.fields.hits.stride + sessions.fields.hits.index] === 2) {
+    console.log("✅ Success: Record fields read and write the table's memory.");
+}
+const soaRow = myAllocator.structAlloc(soaSessions.ptr);
+const soaRecord = new soaSessions.Record(soaRow);
+soaRecord.flags = 7;
+if (soaSessions.fields.flags.array.length === 4 && soaSessions.fields.flags.array[soaRow] === 7 &&
+    soaSessions.fields.id.array instanceof BigUint64Array) {
+    console.log("✅ Success: The SoA table keeps one typed array per column.");
+}
+const freedOnce = myAllocator.structFree(sessions.ptr, rowA);
+const freedTwice = myAllocator.structFree(sessions.ptr, rowA);
+const reusedRow = myAllocator.structAlloc(sessions.ptr);
+record.row = reusedRow;
+if (freedOnce && !freedTwice && reusedRow === rowA && record.hits === 0 && record.id === 0n) {
+    console.log("✅ Success: A freed row came back zeroed, and a second free was refused.");
+}
+const filled = [1, 2, 3].map(() => myAllocator.structAlloc(sessions.ptr));
+if (filled.every((row) => row >= 0) && myAllocator.structAlloc(sessions.ptr) === -1) {
+    console.log("✅ Success: A full table returned -1.");
+}
+const idColumn = sessions.fields.id.array;
+myAllocator.rReset(structArena);
+if (idColumn.length === 0 && soaSessions.fields.flags.array.length === 0) {
+    console.log("✅ Success: Resetting the arena detached the struct arrays.");
+}
+myAllocator.rDestroy(structArena);
+
+// 22. Hash tables: a uint64 -> uint64 session index stored in an arena, grown a step at a time
+console.log("\n--- Hash Tables ---");
+const tableArena = myAllocator.createArena(256 * 1024, LIFETIME.INTERMEDIATE);
+const sessionIndex = myAllocator.createHashTable(tableArena, 8);
+const firstCapacity = myAllocator.hashStats(sessionIndex).capacity;
+let midGrow = null;
+let allFound = true;
+for (let id = 0; id < 100; id++) {
+    myAllocator.hashPut(sessionIndex, id, BigInt(id) * 16n);
+    const stats = myAllocator.hashStats(sessionIndex);
+    if (!midGrow && stats.oldCapacity > 0) midGrow = stats;
+    for (let seen = 0; seen <= id; seen += 7) {
+        if (myAllocator.hashGet(sessionIndex, seen) !== BigInt(seen) * 16n) allFound = false;
+    }
+}
+const indexStats = myAllocator.hashStats(sessionIndex);
+console.log(`Capacity ${firstCapacity} -> ${indexStats.capacity} in ${indexStats.grows} grows, ${midGrow ? midGrow.oldCount : 0} entries left to move at the first check`);
+if (allFound && indexStats.count === 100 && indexStats.capacity > firstCapacity && midGrow && midGrow.oldCount > 0) {
+    console.log("✅ Success: Entries stayed reachable while a grow moved them over.");
+}
+const removed = myAllocator.hashDelete(sessionIndex, 42n);
+if (removed === 672n && myAllocator.hashGet(sessionIndex, 42) === undefined &&
+    myAllocator.hashDelete(sessionIndex, 42) === undefined && myAllocator.hashCount(sessionIndex) === 99) {
+    console.log("✅ Success: Delete returned the value, and a second delete found nothing.");
+}
+let samplesLive = true;
+for (let i = 0; i < 50; i++) {
+    const key = myAllocator.hashSample(sessionIndex);
+    if (key === undefined || key === 42n || myAllocator.hashGet(sessionIndex, key) !== key * 16n) samplesLive = false;
+}
+if (samplesLive) {
+    console.log("✅ Success: Every sample was a live key.");
+}
+const badKeys = [-1, NaN, Infinity, -Infinity, 1.5, 2 ** 64, -1n, 2n ** 64n, "7"];
+const keyRejected = (key) => {
+    try { myAllocator.hashGet(sessionIndex, key); } catch (e) { return e instanceof TypeError; }
+    return false;
+};
+let valueRejected = false;
+try { myAllocator.hashPut(sessionIndex, 7, NaN); } catch (e) { valueRejected = e instanceof TypeError; }
+if (badKeys.every(keyRejected) && valueRejected && !myAllocator.hashPut(sessionIndex, 2n ** 64n - 1n, 1n) &&
+    myAllocator.createHashTable(arenaA, 8) === undefined) {
+    console.log("✅ Success: Unusable keys and non-INTERMEDIATE arenas were refused.");
+}
+myAllocator.destroyHashTable(sessionIndex);
+myAllocator.rDestroy(tableArena);
+
+// 23. A double free of a thread-cached block is refused, so it is not handed out twice
+console.log("\n--- Double Free of a Thread-Cached Block ---");
+const cachedBlock = myAllocator.rAlloc(48);
+myAllocator.rFree(cachedBlock);
+myAllocator.rFree(cachedBlock); // still in this thread's cache
+const firstOut = myAllocator.rAlloc(48);
+const secondOut = myAllocator.rAlloc(48);
+if (firstOut === cachedBlock && secondOut !== cachedBlock) {
+    console.log("✅ Success: The block was cached once and handed out once.");
+}
+myAllocator.rFree(firstOut);
+myAllocator.rFree(secondOut);
+
+// 24. Runs of a small slab arena are mapped run-aligned, so no chunk pads
+// up to a run to line one up
+console.log("\n--- Run-Aligned Chunks ---");
+const RUN_SIZE = 64 * 1024;
+const smallSlab = myAllocator.createArena(4096, LIFETIME.INTERMEDIATE);
+[16, 64, 128, 256, 512, 1024].forEach((size) => myAllocator.rArena(smallSlab, size));
+const smallStats = myAllocator.rArenaStats(smallSlab);
+const smallRuns = smallStats.slabs.reduce((sum, slab) => sum + slab.runs, 0);
+console.log(`${smallRuns} runs, ${smallStats.reservedBytes} bytes reserved in ${smallStats.chunks} chunks`);
+// Geometric growth leaves at most as much again unused
+if (smallRuns === 6 && smallStats.reservedBytes <= smallStats.capacity + 2 * smallRuns * RUN_SIZE) {
+    console.log("✅ Success: Reserved bytes stay within twice what the runs need.");
+}
+myAllocator.rDestroy(smallSlab);
+const cappedSlab = myAllocator.createArena(4096, LIFETIME.INTERMEDIATE, 4096 + 3 * RUN_SIZE);
+const cappedSlots = [16, 128, 1024].map((size) => myAllocator.rArena(cappedSlab, size));
+if (cappedSlots.every((ptr) => ptr !== 0n)) {
+    console.log("✅ Success: A cap of three runs holds three classes.");
+}
+myAllocator.rDestroy(cappedSlab);
+
+myAllocator.rDestroy(arenaA);
+myAllocator.rDestroy(arenaC);
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Offline trainer: turns a PROFILING_MODE trace into a per-site lifetime policy.
+// Usage: node train_policy.js [training_data.bin] [policy.csv]
+// (CSV traces from older builds are still accepted)
+// Load the result with R_ALLOC_POLICY=policy.csv or myAllocator.loadPolicy(path).
+const fs = require('fs');
+
+const input = process.argv[2] || 'training_data.bin';
+const output = process.argv[3] || 'policy.csv';
+
+// CONFIG (lifespans in ns)
+const TRANSIENT_P90_NS = 1e6;      // 90% dead within 1ms -> TRANSIENT
+const PERSISTENT_P50_NS = 1e9;     // median older than 1s -> PERSISTENT
+const PERSISTENT_LIVE_RATIO = 0.5; // or mostly still alive at flush time
+const SIZE_CLASS_SLACK = 1.25;     // round up to the site's max only if it wastes < 25%
+const MAX_SIZE_CLASS = 4096;
+
+const LIFETIME = { TRANSIENT: 0, INTERMEDIATE: 1, PERSISTENT: 2 };
+const LIFETIME_NAMES = ['TRANSIENT', 'INTERMEDIATE', 'PERSISTENT'];
+
+const PROFILE_MAGIC = 0x46525052; // "RPRF"
+const PROFILE_HEADER_SIZE = 16;
+
+// Calls visit(site, size, lifespanNs, live) for every record in the trace
+function readTrace(file, visit) {
+    const data = fs.readFileSync(file);
+    if (data.length >= PROFILE_HEADER_SIZE && data.readUInt32LE(0) === PROFILE_MAGIC) {
+        const recordSize = data.readUInt32LE(8);
+        const sampleRate = data.readUInt32LE(12);
+        console.log(`Binary trace, sampled 1 in ${sampleRate}`);
+        for (let off = PROFILE_HEADER_SIZE; off + recordSize <= data.length; off += recordSize) {
+            visit(data.readUInt32LE(off), Number(data.readBigUInt64LE(off + 8)),
+                  Number(data.readBigUInt64LE(off + 16)), data.readUInt32LE(off + 4));
+        }
+        return;
+    }
+    const lines = data.toString('utf8').split('\n');
+    for (let i = 1; i < lines.length; i++) {
+        if (!lines[i]) continue;
+        const [site, size, lifespan, live] = lines[i].split(',').map(Number);
+        visit(site, size, lifespan, live || 0);
+    }
+}
+
+// 1. Group the trace by site
+const sites = new Map();
+readTrace(input, (site, size, lifespan, live) => {
+    if (site === 0) return; // untagged allocations cannot be routed
+
+    let s = sites.get(site);
+    if (!s) {
+        s = { lifespans: [], live: 0, minSize: Infinity, maxSize: 0 };
+        sites.set(site, s);
+    }
+    s.lifespans.push(lifespan);
+    if (live) s.live++;
+    if (size < s.minSize) s.minSize = size;
+    if (size > s.maxSize) s.maxSize = size;
+});
+
+function percentile(sorted, p) {
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+// 2. Classify every site
+const rows = ['site_id,lifetime,size_class'];
+const report = [];
+for (const [site, s] of [...sites].sort((a, b) => a[0] - b[0])) {
+    s.lifespans.sort((a, b) => a - b);
+    const p50 = percentile(s.lifespans, 0.5);
+    const p90 = percentile(s.lifespans, 0.9);
+    const liveRatio = s.live / s.lifespans.length;
+
+    let lifetime = LIFETIME.INTERMEDIATE;
+    if (liveRatio >= PERSISTENT_LIVE_RATIO || p50 >= PERSISTENT_P50_NS) {
+        lifetime = LIFETIME.PERSISTENT;
+    } else if (p90 <= TRANSIENT_P90_NS) {
+        lifetime = LIFETIME.TRANSIENT;
+    }
+
+    // A site whose sizes are tightly clustered gets one size, so its freed
+    // blocks can be reused by any of its later requests
+    const rounded = (s.maxSize + 7) & ~7;
+    const sizeClass = rounded <= MAX_SIZE_CLASS && rounded <= s.minSize * SIZE_CLASS_SLACK ? rounded : 0;
+
+    rows.push(`${site},${lifetime},${sizeClass}`);
+    report.push({
+        site,
+        samples: s.lifespans.length,
+        'p50 (us)': (p50 / 1000).toFixed(1),
+        'p90 (us)': (p90 / 1000).toFixed(1),
+        live: `${(liveRatio * 100).toFixed(0)}%`,
+        lifetime: LIFETIME_NAMES[lifetime],
+        sizeClass,
+    });
+}
+
+fs.writeFileSync(output, rows.join('\n') + '\n');
+console.table(report);
+console.log(`Wrote ${report.length} sites to ${output}`);
@@ -0,0 +1,81 @@
+// Zero-Copy View Testing
+const myAllocator = require('./build/Release/my_allocator');
+
+const LIFETIME = { TRANSIENT: 0, INTERMEDIATE: 1, PERSISTENT: 2 };
+
+myAllocator.init();
+
+// 1. r_alloc block: write from JS, read back through a second view
+console.log("--- View Over an rAlloc Block ---");
+const ptr = myAllocator.rAlloc(64);
+const bytes = new Uint8Array(myAllocator.rView(ptr, 64));
+bytes.set([1, 2, 3, 4]);
+const dv = new DataView(myAllocator.rView(ptr, 64));
+console.log(`First word (LE): 0x${dv.getUint32(0, true).toString(16)}`);
+if (dv.getUint32(0, true) === 0x04030201) {
+    console.log("✅ Success: Two views share the same off-heap memory.");
+}
+
+// 2. rFree detaches every view over the block
+myAllocator.rFree(ptr);
+if (bytes.byteLength === 0 && dv.buffer.byteLength === 0) {
+    console.log("✅ Success: rFree detached the views (no dangling access).");
+}
+
+// 3. Whole-chunk arena view with offsets
+console.log("\n--- View Over an Arena Chunk ---");
+const arena = myAllocator.createArena(4096, LIFETIME.TRANSIENT);
+const chunk = myAllocator.rArenaView(arena);
+const base = myAllocator.rArena(arena, 16);
+const next = myAllocator.rArena(arena, 16);
+const offset = Number(next - base);
+new Uint8Array(chunk)[offset] = 42;
+if (new Uint8Array(myAllocator.rArenaView(arena, next, 16))[0] === 42) {
+    console.log(`✅ Success: Chunk view offset ${offset} matches the allocation.`);
+}
+
+// 4. Buffer.from(arrayBuffer) wraps without copying (usable with fs/net)
+const buf = Buffer.from(myAllocator.rArenaView(arena, base, 16));
+buf.write("off-heap");
+if (Buffer.from(chunk, 0, 8).toString() === "off-heap") {
+    console.log("✅ Success: Buffer shares the arena memory.");
+}
+
+// 5. Reset detaches everything handed out by the arena
+myAllocator.rReset(arena);
+if (chunk.byteLength === 0 && buf.byteLength === 0) {
+    console.log("✅ Success: rReset detached all arena views.");
+}
+
+// 6. Rewind detaches the views over memory allocated after the mark
+console.log("\n--- Rewind and Length Checks ---");
+const kept = myAllocator.rArena(arena, 32);
+const keptView = new Uint8Array(myAllocator.rArenaView(arena, kept, 32));
+const mark = myAllocator.rArenaMark(arena);
+const dropped = myAllocator.rArena(arena, 32);
+const droppedView = new Uint8Array(myAllocator.rArenaView(arena, dropped, 32));
+const big = myAllocator.rArena(arena, 8192); // chains a chunk
+const bigView = new Uint8Array(myAllocator.rArenaView(arena, big, 8192));
+if (myAllocator.rArenaRewind(arena, mark) && droppedView.byteLength === 0 &&
+    bigView.byteLength === 0 && keptView.byteLength === 32) {
+    console.log("✅ Success: rArenaRewind detached the views past the mark only.");
+}
+
+// 7. Views may not run past their block / allocation
+const small = myAllocator.rAlloc(64);
+const last = myAllocator.rArena(arena, 16);
+if (myAllocator.rView(small, 1 << 20) === undefined && myAllocator.rView(small, 64) !== undefined &&
+    myAllocator.rArenaView(arena, last, 17) === undefined && myAllocator.rArenaView(arena, last, 16) !== undefined) {
+    console.log("✅ Success: Oversized rView / rArenaView lengths are refused.");
+}
+myAllocator.rFree(small);
+// `small` now sits in this thread's cache, to be handed out again
+if (myAllocator.rView(small, 16) === undefined) {
+    console.log("✅ Success: rView refused a block freed into the thread cache.");
+}
+
+// 8. Views dropped by JS are cleaned up by the GC finalizer
+for (let i = 0; i < 10000; i++) myAllocator.rArenaView(arena, myAllocator.rArena(arena, 8), 8);
+if (global.gc) global.gc();
+myAllocator.rDestroy(arena);
+console.log("✅ Success: Arena destroyed with collected and live views.");
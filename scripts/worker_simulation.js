@@ -0,0 +1,122 @@
+// Multi-Worker Scaling (worker_threads)
+// PROFILING_MODE 1 builds share the sample table and ring between threads,
+// so keep the sample rate sparse (the default) when measuring scaling.
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+const { performance } = require('perf_hooks');
+const myAllocator = require('./build/Release/my_allocator');
+
+// CONFIG
+const OPS_PER_WORKER = 1000000;
+const WORKER_COUNTS = [1, 2, 4, 8];
+const SIZES = [32, 64, 128, 256]; // Thread-cached sizes
+const LIVE_WINDOW = 256;          // Objects each worker keeps alive
+const LIFETIME = { TRANSIENT: 0, INTERMEDIATE: 1, PERSISTENT: 2 };
+
+if (!isMainThread && workerData.mode === 'free') {
+    // ==========================================
+    // WORKER: frees slabs owned by the main thread's arena (remote free)
+    // ==========================================
+    myAllocator.init();
+    let freed = 0;
+    for (const ptr of workerData.ptrs) {
+        if (myAllocator.rArenaFree(workerData.arena, ptr)) freed++;
+    }
+    parentPort.postMessage(freed);
+} else if (!isMainThread) {
+    // ==========================================
+    // WORKER: alloc/free churn + a private slab arena
+    // ==========================================
+    myAllocator.init(); // Shared heap, only the first call maps it
+    const arena = myAllocator.createArena(1024 * 1024, LIFETIME.INTERMEDIATE);
+    const window = new Array(LIVE_WINDOW).fill(0n);
+    const slabs = new Array(LIVE_WINDOW).fill(0n);
+
+    const start = performance.now();
+    for (let i = 0; i < workerData.ops; i++) {
+        const slot = i % LIVE_WINDOW;
+        const size = SIZES[i & 3];
+
+        if (window[slot] !== 0n) myAllocator.rFree(window[slot]);
+        window[slot] = myAllocator.rAlloc(size);
+
+        if (slabs[slot] !== 0n) myAllocator.rArenaFree(arena, slabs[slot]);
+        slabs[slot] = myAllocator.rArena(arena, 128);
+    }
+    const elapsed = performance.now() - start;
+
+    window.forEach(p => myAllocator.rFree(p));
+    myAllocator.rDestroy(arena);
+    parentPort.postMessage(elapsed);
+} else {
+    // ==========================================
+    // MAIN: run each worker count and report aggregate throughput
+    // ==========================================
+    myAllocator.init();
+
+    const runWith = (count) => new Promise((resolve, reject) => {
+        let done = 0;
+        const start = performance.now();
+        for (let w = 0; w < count; w++) {
+            const worker = new Worker(__filename, { workerData: { mode: 'churn', ops: OPS_PER_WORKER } });
+            worker.on('error', reject);
+            worker.on('message', () => {
+                if (++done === count) resolve(performance.now() - start);
+            });
+        }
+    });
+
+    (async () => {
+        console.log("=== MULTI-WORKER SCALING ===");
+        console.log(`${OPS_PER_WORKER} iterations per worker (2 allocs + 2 frees each)\n`);
+
+        const results = [];
+        let baseline = 0;
+        for (const count of WORKER_COUNTS) {
+            const elapsed = await runWith(count);
+            const opsPerSec = (count * OPS_PER_WORKER * 4) / (elapsed / 1000);
+            if (count === 1) baseline = opsPerSec;
+            results.push({
+                'Workers': count,
+                'Time (ms)': elapsed.toFixed(2),
+                'Ops/Sec': opsPerSec.toFixed(0),
+                'Speedup': (opsPerSec / baseline).toFixed(2) + 'x'
+            });
+        }
+        console.table(results);
+
+        // Pipeline: this thread allocates sessions, another worker frees them
+        console.log("\n--- Cross-Worker Free (Remote Free Queue) ---");
+        const arena = myAllocator.createArena(1024 * 1024, LIFETIME.INTERMEDIATE);
+        const ptrs = [];
+        for (let i = 0; i < 1000; i++) ptrs.push(myAllocator.rArena(arena, 128));
+
+        const freeFromWorker = () => new Promise((resolve, reject) => {
+            const worker = new Worker(__filename, { workerData: { mode: 'free', arena, ptrs } });
+            worker.on('error', reject);
+            worker.on('message', resolve);
+        });
+        const firstPass = await freeFromWorker();
+        // Still queued for the owner: a second free from another worker is
+        // refused before the owner ever sees the first
+        const secondPass = await freeFromWorker();
+        console.log(`Worker freed ${firstPass}/1000, then ${secondPass}/1000 again`);
+        if (firstPass === 1000 && secondPass === 0) {
+            console.log("✅ Success: Double frees from a second worker were refused.");
+        }
+
+        // The owner drains the remote queue on its next rArena call
+        const issued = new Set(ptrs);
+        let reused = 0;
+        for (let i = 0; i < 1000; i++) {
+            if (issued.has(myAllocator.rArena(arena, 128))) reused++;
+        }
+        // Freed slots go back to their own runs, so the owner may carve what is
+        // left of its current run first; without the drain it would hold 2000
+        const slab = myAllocator.rArenaStats(arena).slabs.find((s) => s.size === 128);
+        console.log(`Reused ${reused}/1000 slots freed by another worker, ${slab.allocated} live`);
+        if (reused > 0 && slab.allocated === 1000) {
+            console.log("✅ Success: Remote frees were handed back to the owner.");
+        }
+        myAllocator.rDestroy(arena);
+    })();
+}
@@ -1,13 +1,69 @@
 #include <node_api.h>
 #include "allocator.h"
 #include "arena.h"
+#include "views.h"
+#include "handles.h"
+#include "trace.h"
+#include "structs.h"
+#include "hashtable.h"
 #include <stdbool.h>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Per-env state (each worker_threads worker gets its own), handed to every
+// wrapper as its callback data
+typedef struct {
+    view_registry_t* views;
+    handle_table_t* handles; // handle mode (rAllocH, rArenaH, ...)
+    napi_ref record_factory; // builds a struct table's Record class (NULL until first used)
+} addon_state_t;
+
+static void FinalizeAddonState(napi_env env, void* data, void* hint) {
+    addon_state_t* state = (addon_state_t*)data;
+    release_view_registry(state->views);
+    destroy_handle_table(state->handles);
+    if (state->record_factory) napi_delete_reference(env, state->record_factory);
+    delete state;
+}
+
+// Stats objects: byte counts fit a double exactly up to 2^53
+static void set_number(napi_env env, napi_value object, const char* name, double value) {
+    napi_value number;
+    napi_create_double(env, value, &number);
+    napi_set_named_property(env, object, name, number);
+}
 
 // wrapper for init_heap
+// JS Usage: init() or init(segment_size[, max_heap_size]). segment_size must be
+// at least 4096; max_heap_size omitted or 0 keeps the default 1GB cap.
 napi_value InitHeapWrapper(napi_env env, napi_callback_info info) {
-    init_heap();
-    return NULL; // Returns undefined to JS
+    size_t argc = 2;
+    napi_value args[2];
+    int64_t segment_size = 0;
+    int64_t max_size = 0;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc == 0) {
+        init_heap();
+        return NULL; // Returns undefined to JS
+    }
+
+    napi_get_value_int64(env, args[0], &segment_size);
+    if (argc > 1) {
+        napi_get_value_int64(env, args[1], &max_size);
+    }
+    if (segment_size < 4096 || max_size < 0) {
+        napi_throw_range_error(env, NULL, "segment size must be at least 4096 bytes and the cap >= 0");
+        return NULL;
+    }
+    if (!init_heap_config((size_t)segment_size, (size_t)max_size)) {
+        napi_throw_error(env, NULL, "could not map the first heap segment");
+    }
+    return NULL;
 }
 
 // wrapper for r_alloc
@@ -31,6 +87,7 @@ napi_value AllocWrapper(napi_env env, napi_callback_info info) {
 
     // 4. call the r_alloc function with site_id
     void* resultPtr = r_alloc(size_requested, site_id);
+    trace_alloc(resultPtr, size_requested, 0, site_id);
 
     // 5. return as big int
     napi_value output;
@@ -39,15 +96,39 @@ napi_value AllocWrapper(napi_env env, napi_callback_info info) {
     return output;
 }
 
+// wrapper for r_alloc_aligned
+// JS Usage: rAllocAligned(size, align, site_id) -> 0n unless align is a power of two <= 4096
+napi_value AllocAlignedWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    uint32_t size_requested, align = 0;
+    uint32_t site_id = 0;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_uint32(env, args[0], &size_requested);
+    napi_get_value_uint32(env, args[1], &align);
+    if (argc > 2) {
+        napi_get_value_uint32(env, args[2], &site_id);
+    }
+
+    void* ptr = r_alloc_aligned(size_requested, align, site_id);
+    trace_alloc(ptr, size_requested, align, site_id);
+
+    napi_value output;
+    napi_create_bigint_uint64(env, (uint64_t)ptr, &output);
+    return output;
+}
+
 // wrapper for r_free
 napi_value FreeWrapper(napi_env env, napi_callback_info info) {
     size_t argc = 1;
     napi_value args[1];
     uint64_t ptr_value;
     bool lossless; 
+    addon_state_t* state;
 
     // Get the arguments
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
 
     // covert JS BigInt to C uint64 (The memory address)
     napi_get_value_bigint_uint64(env, args[0], &ptr_value, &lossless);
@@ -55,33 +136,196 @@ napi_value FreeWrapper(napi_env env, napi_callback_info info) {
     // cast it back to a void pointer
     void* ptr = (void*)ptr_value;
 
+    // views over this block must not outlive it
+    detach_views_for_ptr(env, state->views, ptr_value);
+
     // call r_free
+    trace_free(ptr);
     r_free(ptr);
 
     return NULL;
 }
 
-//wrapper for r_defrag
-napi_value DefragWrapper(napi_env env, napi_callback_info info){
-    // r_defrag currently doesn't exist in the new C++ allocator.cpp 
-    // unless you added it back. If it's missing, this is fine as a placeholder.
-    // r_defrag(); 
+//wrapper for r_trim
+// JS Usage: rTrim(budget) -> bytes handed back to the OS (budget 0 / omitted = whole heap)
+// Also exported under its old name, rDefrag.
+napi_value TrimWrapper(napi_env env, napi_callback_info info){
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t budget = 0;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc > 0) {
+        napi_get_value_uint32(env, args[0], &budget);
+    }
+
+    size_t released = r_trim(budget);
+
+    napi_value output;
+    napi_create_double(env, (double)released, &output);
+    return output;
+}
+
+// wrapper for r_fragmentation
+// JS Usage: rFragmentation() -> 0..1 (1 - largest free block / total free)
+napi_value FragmentationWrapper(napi_env env, napi_callback_info info){
+    napi_value output;
+    napi_create_double(env, r_fragmentation(), &output);
+    return output;
+}
+
+// wrapper for r_stats
+// JS Usage: rStats() -> { mappedBytes, maxBytes, segments, hugePages, usedBytes,
+//                         peakUsedBytes, freeBytes, freeBlocks, largestFreeBlock,
+//                         largeObjects, largeBytes, fragmentation }
+napi_value StatsWrapper(napi_env env, napi_callback_info info){
+    heap_stats_t stats;
+    r_stats(&stats);
+
+    napi_value output;
+    napi_create_object(env, &output);
+    set_number(env, output, "mappedBytes", (double)stats.mapped_bytes);
+    set_number(env, output, "maxBytes", (double)stats.max_bytes);
+    set_number(env, output, "segments", (double)stats.segment_count);
+    set_number(env, output, "hugePages", (double)stats.huge_pages);
+    set_number(env, output, "usedBytes", (double)stats.used_bytes);
+    set_number(env, output, "peakUsedBytes", (double)stats.peak_used_bytes);
+    set_number(env, output, "freeBytes", (double)stats.free_bytes);
+    set_number(env, output, "freeBlocks", (double)stats.free_blocks);
+    set_number(env, output, "largestFreeBlock", (double)stats.largest_free_block);
+    set_number(env, output, "largeObjects", (double)stats.large_objects);
+    set_number(env, output, "largeBytes", (double)stats.large_bytes);
+    set_number(env, output, "fragmentation", r_fragmentation());
+    return output;
+}
+
+// wrapper for r_load_policy
+// JS Usage: loadPolicy(path) -> number of sites loaded (0 if the file could not be read)
+napi_value LoadPolicyWrapper(napi_env env, napi_callback_info info){
+    size_t argc = 1;
+    napi_value args[1];
+    char path[4096];
+    size_t length;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc < 1 || napi_get_value_string_utf8(env, args[0], path, sizeof(path), &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "path must be a string");
+        return NULL;
+    }
+
+    napi_value output;
+    napi_create_double(env, (double)r_load_policy(path), &output);
+    return output;
+}
+
+// wrapper for flush_profiling_data
+// JS Usage: flushProfile() -> logs still-live allocations and flushes training_data.bin
+napi_value FlushProfileWrapper(napi_env env, napi_callback_info info){
+    flush_profiling_data();
+    return NULL;
+}
+
+// wrapper for r_set_sample_rate
+// JS Usage: setSampleRate(n) (1 = every allocation, n = about 1 in n, 0 = off, omitted = 1 in 4096)
+napi_value SampleRateWrapper(napi_env env, napi_callback_info info){
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t rate = SAMPLE_RATE_DEFAULT;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc > 0) {
+        napi_get_value_uint32(env, args[0], &rate);
+    }
+    r_set_sample_rate(rate);
     return NULL;
 }
 
+// wrapper for r_set_huge_pages
+// JS Usage: setHugePages(mode) before init() (0 = off, 1 = THP, 2 = MAP_HUGETLB)
+// -> the mode in effect (unchanged once the heap exists)
+napi_value HugePagesWrapper(napi_env env, napi_callback_info info){
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t mode = HUGE_PAGES_OFF;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc > 0) {
+        napi_get_value_uint32(env, args[0], &mode);
+    }
+    if (mode <= HUGE_PAGES_HUGETLB) r_set_huge_pages((int)mode);
+
+    napi_value output;
+    napi_create_uint32(env, (uint32_t)r_huge_pages(), &output);
+    return output;
+}
+
+// wrapper for r_set_large_threshold
+// JS Usage: setLargeThreshold(bytes) (0 = off) -> the threshold in effect
+napi_value LargeThresholdWrapper(napi_env env, napi_callback_info info){
+    size_t argc = 1;
+    napi_value args[1];
+    double bytes;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc > 0 && napi_get_value_double(env, args[0], &bytes) == napi_ok && bytes >= 0) {
+        r_set_large_threshold((size_t)bytes);
+    }
+
+    napi_value output;
+    napi_create_double(env, (double)r_large_threshold(), &output);
+    return output;
+}
+
+// wrapper for trace_start
+// JS Usage: startTrace(path) -> false if the file could not be created or a trace is running
+napi_value StartTraceWrapper(napi_env env, napi_callback_info info){
+    size_t argc = 1;
+    napi_value args[1];
+    char path[4096];
+    size_t length;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc < 1 || napi_get_value_string_utf8(env, args[0], path, sizeof(path), &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "path must be a string");
+        return NULL;
+    }
+
+    napi_value output;
+    napi_get_boolean(env, trace_start(path) != 0, &output);
+    return output;
+}
+
+// wrapper for trace_stop
+// JS Usage: stopTrace() -> number of records written
+napi_value StopTraceWrapper(napi_env env, napi_callback_info info){
+    napi_value output;
+    napi_create_double(env, (double)trace_stop(), &output);
+    return output;
+}
+
 // Wrapper for create_arena
+// JS Usage: createArena(size, policy, max_size, flags) (max_size 0 / omitted = unlimited growth,
+// flags: 1 = ARENA_CACHE_ALIGN, every allocation on its own 64 byte line)
 napi_value CreateArenaWrapper(napi_env env, napi_callback_info info) {
-    size_t argc = 2;
-    napi_value args[2];
-    uint32_t size, policy;
+    size_t argc = 4;
+    napi_value args[4];
+    uint32_t size, policy, flags = 0;
+    int64_t max_size = 0;
 
     napi_get_cb_info(env, info, &argc, args, NULL, NULL);
     napi_get_value_uint32(env, args[0], &size);
     napi_get_value_uint32(env, args[1], &policy);
+    if (argc > 2) {
+        napi_get_value_int64(env, args[2], &max_size);
+    }
+    if (argc > 3) {
+        napi_get_value_uint32(env, args[3], &flags);
+    }
 
     // Call YOUR function
     // Note: Cast policy to lifetime_t enum
-    arena_t* arena = create_arena(size, (lifetime_t)policy);
+    arena_t* arena = create_arena_ex(size, (lifetime_t)policy, (size_t)max_size, flags);
+    trace_arena_create(arena, size, policy, (size_t)max_size, flags);
 
     napi_value output;
     napi_create_bigint_uint64(env, (uint64_t)arena, &output);
@@ -115,6 +359,34 @@ napi_value ArenaAllocWrapper(napi_env env, napi_callback_info info) {
     // Call YOUR function (Ensure r_arena in arena.c/cpp accepts site_id!)
     // If r_arena doesn't take site_id yet, update arena.h to match r_alloc
     void* ptr = r_arena(arena, size, site_id);
+    trace_arena_alloc(arena, ptr, size, 0, site_id);
+
+    napi_value output;
+    napi_create_bigint_uint64(env, (uint64_t)ptr, &output);
+    return output;
+}
+
+// Wrapper for r_arena_aligned
+// JS Usage: rArenaAligned(arena_ptr, size, align, site_id) -> 0n unless align is a power of two <= 4096
+napi_value ArenaAllocAlignedWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    uint64_t arena_ptr_val;
+    uint32_t size, align = 0;
+    uint32_t site_id = 0;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
+    napi_get_value_uint32(env, args[1], &size);
+    napi_get_value_uint32(env, args[2], &align);
+    if (argc > 3) {
+        napi_get_value_uint32(env, args[3], &site_id);
+    }
+
+    void* ptr = r_arena_aligned(arena, size, align, site_id);
+    trace_arena_alloc(arena, ptr, size, align, site_id);
 
     napi_value output;
     napi_create_bigint_uint64(env, (uint64_t)ptr, &output);
@@ -127,12 +399,16 @@ napi_value ArenaResetWrapper(napi_env env, napi_callback_info info) {
     napi_value args[1];
     uint64_t arena_ptr_val;
     bool lossless;
+    addon_state_t* state;
 
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
     napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
     arena_t* arena = (arena_t*)arena_ptr_val;
 
+    detach_views_for_arena(env, state->views, arena_ptr_val);
+
     // Call YOUR function
+    trace_arena_reset(arena);
     r_reset(arena);
     return NULL;
 }
@@ -143,25 +419,120 @@ napi_value DestroyArenaWrapper(napi_env env, napi_callback_info info) {
     napi_value args[1];
     uint64_t arena_ptr_val;
     bool lossless;
+    addon_state_t* state;
 
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
     napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
     arena_t* arena = (arena_t*)arena_ptr_val;
 
+    detach_views_for_arena(env, state->views, arena_ptr_val);
+
     // Call YOUR function
+    trace_arena_destroy(arena);
     r_destroy(arena);
     return NULL;
 }
 
-napi_value ArenaFreeWrapper(napi_env env, napi_callback_info info) {
+// Wrapper for acquire_arena: a reset arena from the pool, or a new one
+// JS Usage: acquireArena(policy, size) -> arena_ptr (0n on failure)
+napi_value AcquireArenaWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint32_t policy, size;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_uint32(env, args[0], &policy);
+    napi_get_value_uint32(env, args[1], &size);
+
+    // Traced as a create, so a replay sees the same lifecycle
+    arena_t* arena = acquire_arena((lifetime_t)policy, size);
+    if (arena) trace_arena_create(arena, arena->capacity, policy, 0, 0);
+
+    napi_value output;
+    napi_create_bigint_uint64(env, (uint64_t)arena, &output);
+    return output;
+}
+
+// Wrapper for release_arena: resets the arena and parks it for reuse
+// JS Usage: releaseArena(arena_ptr)
+napi_value ReleaseArenaWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t arena_ptr_val;
+    bool lossless;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
+
+    detach_views_for_arena(env, state->views, arena_ptr_val);
+
+    trace_arena_destroy(arena);
+    release_arena(arena);
+    return NULL;
+}
+
+// Wrapper for prewarm_arenas
+// JS Usage: prewarmArenas(policy, size, count) -> arenas parked for (policy, size)
+napi_value PrewarmArenasWrapper(napi_env env, napi_callback_info info) {
     size_t argc = 3;
     napi_value args[3];
+    uint32_t policy, size, count;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_uint32(env, args[0], &policy);
+    napi_get_value_uint32(env, args[1], &size);
+    napi_get_value_uint32(env, args[2], &count);
+
+    napi_value output;
+    napi_create_double(env, (double)prewarm_arenas((lifetime_t)policy, size, count), &output);
+    return output;
+}
+
+// Wrapper for r_set_arena_pool_limit
+// JS Usage: setArenaPoolLimit(perBucket) (0 = no pooling)
+napi_value ArenaPoolLimitWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t limit;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc > 0 && napi_get_value_uint32(env, args[0], &limit) == napi_ok) {
+        r_set_arena_pool_limit(limit);
+    }
+    return NULL;
+}
+
+// Wrapper for r_arena_pool_stats
+// JS Usage: arenaPoolStats() -> { parked, parkedBytes, hits, misses, dropped, limit }
+napi_value ArenaPoolStatsWrapper(napi_env env, napi_callback_info info) {
+    arena_pool_stats_t stats;
+    r_arena_pool_stats(&stats);
+
+    napi_value output;
+    napi_create_object(env, &output);
+    set_number(env, output, "parked", (double)stats.parked);
+    set_number(env, output, "parkedBytes", (double)stats.parked_bytes);
+    set_number(env, output, "hits", (double)stats.hits);
+    set_number(env, output, "misses", (double)stats.misses);
+    set_number(env, output, "dropped", (double)stats.dropped);
+    set_number(env, output, "limit", (double)stats.limit);
+    return output;
+}
+
+// Wrapper for r_arena_free
+// JS Usage: rArenaFree(arena_ptr, ptr) -> false if the arena never handed out ptr
+// (a third size argument from older callers is accepted and ignored)
+napi_value ArenaFreeWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
     uint64_t arena_ptr_val;
     uint64_t item_ptr_val;
-    uint32_t size;
     bool lossless;
+    addon_state_t* state;
 
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
 
     // 1. Get Arena Handle
     napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
@@ -171,49 +542,1084 @@ napi_value ArenaFreeWrapper(napi_env env, napi_callback_info info) {
     napi_get_value_bigint_uint64(env, args[1], &item_ptr_val, &lossless);
     void* ptr = (void*)item_ptr_val;
 
-    // 3. Get Size (Crucial for Slab!)
-    napi_get_value_uint32(env, args[2], &size);
+    // 3. Call the Free function (the slab run knows the size)
+    int freed = r_arena_free(arena, ptr);
+    if (freed) {
+        trace_arena_free(arena, ptr);
+        detach_views_for_ptr(env, state->views, item_ptr_val);
+    }
+
+    napi_value output;
+    napi_get_boolean(env, freed != 0, &output);
+    return output;
+}
 
-    // Call the Free function
-    r_arena_free(arena, ptr, size);
+// Batched r_arena: one native crossing for N allocations
+// JS Usage: rArenaBatch(arena_ptr, Uint32Array sizes, site_id) -> BigUint64Array
+napi_value ArenaAllocBatchWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    uint64_t arena_ptr_val;
+    uint32_t site_id = 0;
+    bool lossless;
 
-    return NULL;
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
+
+    napi_typedarray_type type;
+    size_t count;
+    void* data;
+    if (napi_get_typedarray_info(env, args[1], &type, &count, &data, NULL, NULL) != napi_ok ||
+        type != napi_uint32_array) {
+        napi_throw_type_error(env, NULL, "sizes must be a Uint32Array");
+        return NULL;
+    }
+    uint32_t* sizes = (uint32_t*)data;
+
+    if (argc > 2) {
+        napi_get_value_uint32(env, args[2], &site_id);
+    }
+
+    // The result buffer comes first, so a failure there allocates nothing;
+    // if wrapping it fails, what was handed out goes back (slots one by
+    // one, bump arenas by rewinding to a mark taken here)
+    void* out_data;
+    napi_value buffer, output;
+    if (napi_create_arraybuffer(env, count * sizeof(uint64_t), &out_data, &buffer) != napi_ok) {
+        napi_throw_error(env, NULL, "could not allocate the result array");
+        return NULL;
+    }
+    uint64_t* ptrs = (uint64_t*)out_data;
+    arena_mark_t mark = r_arena_mark(arena);
+
+    for (size_t i = 0; i < count; i++) {
+        ptrs[i] = (uint64_t)r_arena(arena, sizes[i], site_id);
+        trace_arena_alloc(arena, (void*)ptrs[i], sizes[i], 0, site_id);
+    }
+
+    if (napi_create_typedarray(env, napi_biguint64_array, count, buffer, 0, &output) != napi_ok) {
+        if (arena->policy == LIFETIME_INTERMEDIATE) {
+            for (size_t i = 0; i < count; i++) {
+                if (ptrs[i] && r_arena_free(arena, (void*)ptrs[i])) trace_arena_free(arena, (void*)ptrs[i]);
+            }
+        } else {
+            r_arena_rewind(arena, mark);
+        }
+        napi_throw_error(env, NULL, "could not allocate the result array");
+        return NULL;
+    }
+    return output;
 }
 
-// initialization of function calls
-napi_value Init(napi_env env, napi_value exports) {
-    napi_value fn_init, fn_alloc, fn_free, fn_defrag, 
-    fn_arena_init, fn_arena_alloc, fn_arena_reset, fn_arena_destroy,
-    fn_arena_free;
+// Batched r_arena_free
+// JS Usage: rArenaFreeBatch(arena_ptr, BigUint64Array ptrs) -> number of slots freed
+napi_value ArenaFreeBatchWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t arena_ptr_val;
+    bool lossless;
+    addon_state_t* state;
 
-    // export init_heap
-    napi_create_function(env, NULL, 0, InitHeapWrapper, NULL, &fn_init);
-    napi_set_named_property(env, exports, "init", fn_init);
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
 
-    // export r_alloc
-    napi_create_function(env, NULL, 0, AllocWrapper, NULL, &fn_alloc);
-    napi_set_named_property(env, exports, "rAlloc", fn_alloc);
-    // export r_free
-    napi_create_function(env, NULL, 0, FreeWrapper, NULL, &fn_free);
-    napi_set_named_property(env, exports, "rFree", fn_free);
-    //export r_defrag
-    napi_create_function(env, NULL, 0, DefragWrapper, NULL, &fn_defrag);
-    napi_set_named_property(env, exports, "rDefrag", fn_defrag);
-    //export arena_init
-    napi_create_function(env, NULL, 0, CreateArenaWrapper, NULL, &fn_arena_init);
-    napi_set_named_property(env, exports, "createArena", fn_arena_init);
-    //export arena_alloc
-    napi_create_function(env, NULL, 0, ArenaAllocWrapper, NULL, &fn_arena_alloc);
-    napi_set_named_property(env, exports, "rArena", fn_arena_alloc);
-    //export arena_reset
-    napi_create_function(env, NULL, 0, ArenaResetWrapper, NULL, &fn_arena_reset);
-    napi_set_named_property(env, exports, "rReset", fn_arena_reset);
+    napi_typedarray_type type;
+    size_t count;
+    void* data;
+    if (napi_get_typedarray_info(env, args[1], &type, &count, &data, NULL, NULL) != napi_ok ||
+        type != napi_biguint64_array) {
+        napi_throw_type_error(env, NULL, "ptrs must be a BigUint64Array");
+        return NULL;
+    }
+    uint64_t* ptrs = (uint64_t*)data;
 
-    napi_create_function(env, NULL, 0, DestroyArenaWrapper, NULL, &fn_arena_destroy);
-    napi_set_named_property(env, exports, "rDestroy", fn_arena_destroy);
+    uint32_t freed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (r_arena_free(arena, (void*)ptrs[i])) {
+            trace_arena_free(arena, (void*)ptrs[i]);
+            detach_views_for_ptr(env, state->views, ptrs[i]);
+            freed++;
+        }
+    }
 
-    napi_create_function(env, NULL, 0, ArenaFreeWrapper, NULL, &fn_arena_free);
-    napi_set_named_property(env, exports, "rArenaFree", fn_arena_free);
+    napi_value output;
+    napi_create_uint32(env, freed, &output);
+    return output;
+}
+
+// Wrapper for r_arena_mark
+// JS Usage: rArenaMark(arena) -> { current, size, chunk, epoch }
+napi_value ArenaMarkWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t arena_ptr_val;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
+
+    arena_mark_t mark = r_arena_mark(arena);
+
+    napi_value output, current, size, chunk, epoch;
+    napi_create_object(env, &output);
+    napi_create_bigint_uint64(env, (uint64_t)mark.current, &current);
+    napi_create_double(env, (double)mark.size, &size);
+    napi_create_bigint_uint64(env, (uint64_t)mark.chunk, &chunk);
+    napi_create_bigint_uint64(env, mark.epoch, &epoch);
+    napi_set_named_property(env, output, "current", current);
+    napi_set_named_property(env, output, "size", size);
+    napi_set_named_property(env, output, "chunk", chunk);
+    napi_set_named_property(env, output, "epoch", epoch);
+    return output;
+}
+
+// Wrapper for r_arena_rewind
+// JS Usage: rArenaRewind(arena, mark) -> true if rewound, false for a stale mark
+// Views over memory allocated after the mark are detached.
+napi_value ArenaRewindWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t arena_ptr_val, current, chunk, epoch;
+    double size;
+    bool lossless;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
+
+    napi_value field;
+    napi_get_named_property(env, args[1], "current", &field);
+    napi_get_value_bigint_uint64(env, field, &current, &lossless);
+    napi_get_named_property(env, args[1], "size", &field);
+    napi_get_value_double(env, field, &size);
+    napi_get_named_property(env, args[1], "chunk", &field);
+    napi_get_value_bigint_uint64(env, field, &chunk, &lossless);
+    napi_get_named_property(env, args[1], "epoch", &field);
+    napi_get_value_bigint_uint64(env, field, &epoch, &lossless);
+
+    arena_mark_t mark;
+    mark.current = (void*)current;
+    mark.size = (size_t)size;
+    mark.chunk = (arena_chunk_t*)chunk;
+    mark.epoch = epoch;
+
+    // Memory the rewind gives back: chunks chained since the mark, and the
+    // mark's own chunk past its bump position. Views over it are detached.
+    std::vector<view_range_t> ranges;
+    if (arena && arena->policy != LIFETIME_INTERMEDIATE) {
+        arena_chunk_t* newer = arena->chunks;
+        while (newer && newer != mark.chunk) {
+            ranges.push_back({ (const char*)(newer + 1), (const char*)(newer + 1) + newer->capacity });
+            newer = newer->next;
+        }
+        if (newer == mark.chunk) {
+            const char* end = mark.chunk ? (const char*)(mark.chunk + 1) + mark.chunk->capacity
+                                         : (const char*)arena->base + arena->capacity;
+            ranges.push_back({ (const char*)mark.current, end });
+        }
+    }
+
+    int rewound = r_arena_rewind(arena, mark);
+    if (rewound) detach_views_in_ranges(env, state->views, arena_ptr_val, ranges.data(), ranges.size());
+
+    napi_value output;
+    napi_get_boolean(env, rewound != 0, &output);
+    return output;
+}
+
+// Wrapper for r_arena_stats (call it from the thread that owns the arena)
+// JS Usage: rArenaStats(arena_ptr) -> { policy, usedBytes, peakUsedBytes, capacity,
+//   reservedBytes, maxCapacity, chunks, largeObjects, largeBytes, internalFragmentation,
+//   pooledRuns, releasedRuns, slabs: [{ size, runs, carved, free, allocated, requests, requestedBytes }] }
+// The fields from `internalFragmentation` on are only present for INTERMEDIATE arenas
+napi_value ArenaStatsWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t arena_ptr_val = 0;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc < 1 || napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless) != napi_ok ||
+        arena_ptr_val == 0) {
+        return NULL;
+    }
+
+    arena_stats_t stats;
+    r_arena_stats((arena_t*)arena_ptr_val, &stats);
+
+    napi_value output;
+    napi_create_object(env, &output);
+    set_number(env, output, "policy", (double)stats.policy);
+    set_number(env, output, "usedBytes", (double)stats.used_bytes);
+    set_number(env, output, "peakUsedBytes", (double)stats.peak_used_bytes);
+    set_number(env, output, "capacity", (double)stats.capacity);
+    set_number(env, output, "reservedBytes", (double)stats.reserved_bytes);
+    set_number(env, output, "maxCapacity", (double)stats.max_capacity);
+    set_number(env, output, "chunks", (double)stats.chunk_count);
+    set_number(env, output, "largeObjects", (double)stats.large_objects);
+    set_number(env, output, "largeBytes", (double)stats.large_bytes);
+
+    if (stats.policy == LIFETIME_INTERMEDIATE) {
+        set_number(env, output, "internalFragmentation", stats.internal_fragmentation);
+        set_number(env, output, "pooledRuns", (double)stats.pooled_runs);
+        set_number(env, output, "releasedRuns", (double)stats.released_runs);
+        napi_value slabs;
+        napi_create_array_with_length(env, SLAB_CLASS_COUNT, &slabs);
+        for (uint32_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+            napi_value slab;
+            napi_create_object(env, &slab);
+            set_number(env, slab, "size", (double)stats.slabs[i].class_size);
+            set_number(env, slab, "runs", (double)stats.slabs[i].runs);
+            set_number(env, slab, "carved", (double)stats.slabs[i].carved);
+            set_number(env, slab, "free", (double)stats.slabs[i].free);
+            set_number(env, slab, "allocated", (double)stats.slabs[i].allocated);
+            set_number(env, slab, "requests", (double)stats.slabs[i].requests);
+            set_number(env, slab, "requestedBytes", (double)stats.slabs[i].requested_bytes);
+            napi_set_element(env, slabs, i, slab);
+        }
+        napi_set_named_property(env, output, "slabs", slabs);
+    }
+    return output;
+}
+
+// Zero-copy view over a r_alloc block, detached again by rFree
+// JS Usage: rView(ptr, length) -> ArrayBuffer (wrap in Uint8Array / DataView / Buffer.from),
+// undefined if the block is free (binned or thread-cached) or `length` runs past it
+napi_value ViewWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t ptr_value;
+    uint32_t length;
+    bool lossless;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_bigint_uint64(env, args[0], &ptr_value, &lossless);
+    napi_get_value_uint32(env, args[1], &length);
+    if (!ptr_value || length > r_block_size((void*)ptr_value)) return NULL;
+
+    return create_view(env, state->views, (void*)ptr_value, length, ptr_value, 0);
+}
+
+// Zero-copy view over arena memory, detached by rReset / rDestroy
+// (and by rArenaFree for a single allocation)
+// JS Usage: rArenaView(arena)              -> ArrayBuffer over the first chunk
+//           rArenaView(arena, ptr, length) -> ArrayBuffer over one allocation
+// undefined if `length` runs past the allocation's slot / large object, or past
+// the used part of its chunk in a bump arena
+napi_value ArenaViewWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    uint64_t arena_ptr_val;
+    uint64_t ptr_value;
+    uint32_t length;
+    bool lossless;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    arena_t* arena = (arena_t*)arena_ptr_val;
+
+    if (argc < 3) {
+        return create_view(env, state->views, arena->base, arena->capacity, 0, arena_ptr_val);
+    }
+
+    napi_get_value_bigint_uint64(env, args[1], &ptr_value, &lossless);
+    napi_get_value_uint32(env, args[2], &length);
+    if (length > r_arena_extent(arena, (void*)ptr_value)) return NULL;
+    return create_view(env, state->views, (void*)ptr_value, length, ptr_value, arena_ptr_val);
+}
+
+// ==========================================
+// STRUCTS
+// Schema-defined records in an INTERMEDIATE arena. JS reads and writes
+// fields through typed arrays over the table's memory (views keyed by the
+// table's blocks and its arena, so they detach on destroy / reset), and a
+// table's Record class turns `record.hits++` into one typed array access
+// with no native call.
+// ==========================================
+
+// Compiled once per env. The getters close over one field's array and
+// index math each, which V8 inlines like a plain property load.
+static const char* RECORD_FACTORY_SOURCE =
+    "(function (fields) {\n"
+    "    function Record(row) { this.row = row; }\n"
+    "    Object.keys(fields).forEach(function (name) {\n"
+    "        const array = fields[name].array, stride = fields[name].stride, index = fields[name].index;\n"
+    "        Object.defineProperty(Record.prototype, name, {\n"
+    "            get: function () { return array[this.row * stride + index]; },\n"
+    "            set: function (value) { array[this.row * stride + index] = value; },\n"
+    "            enumerable: true\n"
+    "        });\n"
+    "    });\n"
+    "    return Record;\n"
+    "})";
+
+static const napi_typedarray_type FIELD_ARRAY_TYPES[FIELD_TYPE_COUNT] = {
+    napi_uint8_array, napi_int8_array, napi_uint16_array, napi_int16_array,
+    napi_uint32_array, napi_int32_array, napi_float32_array,
+    napi_biguint64_array, napi_bigint64_array, napi_float64_array
+};
+static const char* FIELD_TYPE_LABELS[FIELD_TYPE_COUNT] = {
+    "u8", "i8", "u16", "i16", "u32", "i32", "f32", "u64", "i64", "f64"
+};
+
+// Reads { name: "type", ... } (declaration order), or the `fields` of an
+// object defineStruct returned. 0 if it does not describe a valid schema.
+static int read_schema(napi_env env, napi_value spec, struct_schema_t* schema) {
+    napi_valuetype kind;
+    if (napi_typeof(env, spec, &kind) != napi_ok || kind != napi_object) return 0;
+
+    bool described = false;
+    napi_has_named_property(env, spec, "fields", &described);
+    if (described) napi_get_named_property(env, spec, "fields", &spec);
+
+    napi_value keys;
+    uint32_t count;
+    if (napi_get_property_names(env, spec, &keys) != napi_ok) return 0;
+    napi_get_array_length(env, keys, &count);
+    if (count == 0 || count > STRUCT_MAX_FIELDS) return 0;
+
+    char names[STRUCT_MAX_FIELDS][STRUCT_NAME_MAX];
+    const char* name_ptrs[STRUCT_MAX_FIELDS];
+    field_type_t types[STRUCT_MAX_FIELDS];
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value key, value;
+        char type[8];
+        size_t length;
+        napi_get_element(env, keys, i, &key);
+        if (napi_get_value_string_utf8(env, key, names[i], STRUCT_NAME_MAX, &length) != napi_ok ||
+            length >= STRUCT_NAME_MAX - 1) {
+            return 0;
+        }
+        napi_get_property(env, spec, key, &value);
+        if (described) napi_get_named_property(env, value, "type", &value);
+        if (napi_get_value_string_utf8(env, value, type, sizeof(type), &length) != napi_ok) return 0;
+        int field_type = field_type_from_name(type);
+        if (field_type < 0) return 0;
+        name_ptrs[i] = names[i];
+        types[i] = (field_type_t)field_type;
+    }
+    return struct_schema_init(schema, name_ptrs, types, count);
+}
+
+// JS Usage: defineStruct({ id: "u64", loginTime: "f64", flags: "u32", ... })
+//   -> { size, align, fields: { id: { type, offset, size }, ... } } (null if invalid)
+// Types: u8 i8 u16 i16 u32 i32 f32 u64 i64 f64. 64-bit integers are BigInts.
+napi_value DefineStructWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    struct_schema_t schema;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc < 1 || !read_schema(env, args[0], &schema)) return NULL;
+
+    napi_value output, fields;
+    napi_create_object(env, &output);
+    napi_create_object(env, &fields);
+    set_number(env, output, "size", (double)schema.size);
+    set_number(env, output, "align", (double)schema.align);
+    for (uint32_t i = 0; i < schema.field_count; i++) {
+        napi_value field, type;
+        napi_create_object(env, &field);
+        napi_create_string_utf8(env, FIELD_TYPE_LABELS[schema.fields[i].type], NAPI_AUTO_LENGTH, &type);
+        napi_set_named_property(env, field, "type", type);
+        set_number(env, field, "offset", (double)schema.fields[i].offset);
+        set_number(env, field, "size", (double)schema.fields[i].size);
+        napi_set_named_property(env, fields, schema.fields[i].name, field);
+    }
+    napi_set_named_property(env, output, "fields", fields);
+    return output;
+}
+
+static napi_value record_class(napi_env env, addon_state_t* state, napi_value fields) {
+    napi_value factory, global, record;
+    if (state->record_factory) {
+        napi_get_reference_value(env, state->record_factory, &factory);
+    } else {
+        napi_value source;
+        napi_create_string_utf8(env, RECORD_FACTORY_SOURCE, NAPI_AUTO_LENGTH, &source);
+        if (napi_run_script(env, source, &factory) != napi_ok) return NULL;
+        napi_create_reference(env, factory, 1, &state->record_factory);
+    }
+    napi_get_global(env, &global);
+    if (napi_call_function(env, global, factory, 1, &fields, &record) != napi_ok) return NULL;
+    return record;
+}
+
+// JS Usage: createStructTable(arena_ptr, struct, capacity, layout) with layout "aos" (default) or "soa"
+//   -> { ptr, layout, capacity, recordSize, fields: { name: { array, stride, index, type } }, Record }
+// Field `name` of row r is fields[name].array[r * stride + index]; new table.Record(r)
+// wraps that in getters / setters (set `.row` to move it). null on failure.
+napi_value CreateStructTableWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    uint64_t arena_ptr_val;
+    uint32_t capacity;
+    bool lossless;
+    addon_state_t* state;
+    struct_schema_t schema;
+    struct_layout_t layout = STRUCT_AOS;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    if (argc < 3 || napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless) != napi_ok ||
+        !read_schema(env, args[1], &schema) || napi_get_value_uint32(env, args[2], &capacity) != napi_ok) {
+        return NULL;
+    }
+    if (argc > 3) {
+        char name[8];
+        size_t length;
+        if (napi_get_value_string_utf8(env, args[3], name, sizeof(name), &length) != napi_ok) return NULL;
+        if (strcmp(name, "soa") == 0) layout = STRUCT_SOA;
+        else if (strcmp(name, "aos") != 0) return NULL;
+    }
+
+    struct_table_t* table = create_struct_table((arena_t*)arena_ptr_val, &schema, capacity, layout);
+    if (!table) return NULL;
+
+    napi_value output, fields, value, buffer = NULL;
+    napi_create_object(env, &output);
+    napi_create_object(env, &fields);
+    napi_create_bigint_uint64(env, (uint64_t)table, &value);
+    napi_set_named_property(env, output, "ptr", value);
+    napi_create_string_utf8(env, layout == STRUCT_SOA ? "soa" : "aos", NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, output, "layout", value);
+    set_number(env, output, "capacity", (double)capacity);
+    set_number(env, output, "recordSize", (double)schema.size);
+
+    if (layout == STRUCT_AOS) {
+        buffer = create_view(env, state->views, table->data, (size_t)capacity * schema.size,
+                             (uint64_t)table->data, arena_ptr_val);
+        if (!buffer) return NULL;
+    }
+    for (uint32_t i = 0; i < schema.field_count; i++) {
+        const struct_field_t* f = &schema.fields[i];
+        size_t length, stride, index;
+        if (layout == STRUCT_AOS) {
+            // Records are a multiple of every field's size, so each field is
+            // a strided slice of one typed array over the whole table
+            length = (size_t)capacity * schema.size / f->size;
+            stride = schema.size / f->size;
+            index = f->offset / f->size;
+        } else {
+            buffer = create_view(env, state->views, table->columns[i], (size_t)capacity * f->size,
+                                 (uint64_t)table->columns[i], arena_ptr_val);
+            if (!buffer) return NULL;
+            length = capacity;
+            stride = 1;
+            index = 0;
+        }
+
+        napi_value field, array, type;
+        napi_create_object(env, &field);
+        napi_create_typedarray(env, FIELD_ARRAY_TYPES[f->type], length, buffer, 0, &array);
+        napi_set_named_property(env, field, "array", array);
+        set_number(env, field, "stride", (double)stride);
+        set_number(env, field, "index", (double)index);
+        napi_create_string_utf8(env, FIELD_TYPE_LABELS[f->type], NAPI_AUTO_LENGTH, &type);
+        napi_set_named_property(env, field, "type", type);
+        napi_set_named_property(env, fields, f->name, field);
+    }
+    napi_set_named_property(env, output, "fields", fields);
+
+    napi_value record = record_class(env, state, fields);
+    if (record) napi_set_named_property(env, output, "Record", record);
+    return output;
+}
+
+// JS Usage: destroyStructTable(table_ptr): memory back to the arena, views detached
+napi_value DestroyStructTableWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t table_ptr_val;
+    bool lossless;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    struct_table_t* table = (struct_table_t*)table_ptr_val;
+    if (!table) return NULL;
+
+    detach_views_for_ptr(env, state->views, (uint64_t)table->data);
+    for (uint32_t i = 0; i < table->schema.field_count; i++) {
+        detach_views_for_ptr(env, state->views, (uint64_t)table->columns[i]);
+    }
+    destroy_struct_table(table);
+    return NULL;
+}
+
+// JS Usage: structAlloc(table_ptr) -> row of a zeroed record, -1 when the table is full
+napi_value StructAllocWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t table_ptr_val;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+
+    uint32_t row = struct_alloc((struct_table_t*)table_ptr_val);
+    napi_value output;
+    napi_create_int32(env, row == STRUCT_NO_ROW ? -1 : (int32_t)row, &output);
+    return output;
+}
+
+// JS Usage: structFree(table_ptr, row) -> false if the row is not live
+napi_value StructFreeWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t table_ptr_val;
+    uint32_t row;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    napi_get_value_uint32(env, args[1], &row);
+
+    napi_value output;
+    napi_get_boolean(env, struct_free((struct_table_t*)table_ptr_val, row), &output);
+    return output;
+}
+
+// ==========================================
+// HASH TABLES
+// uint64 -> uint64 maps kept in an INTERMEDIATE arena (session id ->
+// session pointer ...), so a session store needs no JS Map. Keys may be
+// Numbers or BigInts; values are BigInts, as rArena returns them.
+// ==========================================
+
+// A Number or BigInt that is an integer in [0, 2^64). Anything else throws
+// a TypeError naming `what` and returns 0. The range is checked before the
+// cast, which is undefined for NaN and for doubles out of range.
+static int read_u64(napi_env env, napi_value value, const char* what, uint64_t* out) {
+    napi_valuetype kind;
+    napi_typeof(env, value, &kind);
+    if (kind == napi_bigint) {
+        bool lossless;
+        if (napi_get_value_bigint_uint64(env, value, out, &lossless) == napi_ok && lossless) return 1;
+    } else if (kind == napi_number) {
+        double number;
+        napi_get_value_double(env, value, &number);
+        if (number >= 0 && number < 18446744073709551616.0 && number == floor(number)) {
+            *out = (uint64_t)number;
+            return 1;
+        }
+    }
+    char message[96];
+    snprintf(message, sizeof(message), "%s must be an integer between 0 and 2^64 - 1", what);
+    napi_throw_type_error(env, NULL, message);
+    return 0;
+}
+
+// JS Usage: createHashTable(arena_ptr, capacity) -> table pointer, or null
+// (the arena must be INTERMEDIATE). `capacity` only sizes the first slot array.
+napi_value CreateHashTableWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t arena_ptr_val;
+    uint32_t capacity = 0;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &arena_ptr_val, &lossless);
+    if (argc > 1) napi_get_value_uint32(env, args[1], &capacity);
+
+    hash_table_t* table = create_hash_table((arena_t*)arena_ptr_val, capacity);
+    if (!table) return NULL;
+
+    napi_value output;
+    napi_create_bigint_uint64(env, (uint64_t)table, &output);
+    return output;
+}
+
+// JS Usage: destroyHashTable(table_ptr)
+napi_value DestroyHashTableWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t table_ptr_val;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    destroy_hash_table((hash_table_t*)table_ptr_val);
+    return NULL;
+}
+
+// JS Usage: hashPut(table_ptr, key, value) -> false for key 2^64 - 1 or out of memory;
+// throws a TypeError for a key or value that is not an integer in [0, 2^64)
+napi_value HashPutWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    uint64_t table_ptr_val, key, value;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+
+    if (!read_u64(env, args[1], "key", &key) || !read_u64(env, args[2], "value", &value)) return NULL;
+    napi_value output;
+    napi_get_boolean(env, hash_put((hash_table_t*)table_ptr_val, key, value), &output);
+    return output;
+}
+
+// JS Usage: hashGet(table_ptr, key) -> value (BigInt), or undefined
+napi_value HashGetWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t table_ptr_val, key, value;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    if (!read_u64(env, args[1], "key", &key) || !hash_get((hash_table_t*)table_ptr_val, key, &value)) return NULL;
+
+    napi_value output;
+    napi_create_bigint_uint64(env, value, &output);
+    return output;
+}
+
+// JS Usage: hashDelete(table_ptr, key) -> the removed value (BigInt), or undefined
+// Returning the value lets a logout free the session in the same breath.
+napi_value HashDeleteWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint64_t table_ptr_val, key, value;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    if (!read_u64(env, args[1], "key", &key) || !hash_remove((hash_table_t*)table_ptr_val, key, &value)) return NULL;
+
+    napi_value output;
+    napi_create_bigint_uint64(env, value, &output);
+    return output;
+}
+
+// JS Usage: hashSample(table_ptr) -> a random key (BigInt), or undefined if empty
+napi_value HashSampleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t table_ptr_val, key;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    if (!hash_sample((hash_table_t*)table_ptr_val, &key, NULL)) return NULL;
+
+    napi_value output;
+    napi_create_bigint_uint64(env, key, &output);
+    return output;
+}
+
+// JS Usage: hashCount(table_ptr) -> entries
+napi_value HashCountWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t table_ptr_val;
+    bool lossless;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+
+    napi_value output;
+    napi_create_uint32(env, hash_count((hash_table_t*)table_ptr_val), &output);
+    return output;
+}
+
+// JS Usage: hashStats(table_ptr) -> { count, capacity, oldCapacity, oldCount, grows, bytes }
+// oldCapacity / oldCount are non-zero while a grow is still moving entries.
+napi_value HashStatsWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint64_t table_ptr_val;
+    bool lossless;
+    hash_table_stats_t stats;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_get_value_bigint_uint64(env, args[0], &table_ptr_val, &lossless);
+    if (!table_ptr_val) return NULL;
+    hash_table_stats((hash_table_t*)table_ptr_val, &stats);
+
+    napi_value output;
+    napi_create_object(env, &output);
+    set_number(env, output, "count", (double)stats.count);
+    set_number(env, output, "capacity", (double)stats.capacity);
+    set_number(env, output, "oldCapacity", (double)stats.old_capacity);
+    set_number(env, output, "oldCount", (double)stats.old_count);
+    set_number(env, output, "grows", (double)stats.grows);
+    set_number(env, output, "bytes", (double)stats.bytes);
+    return output;
+}
+
+// ==========================================
+// HANDLE MODE
+// Same operations as above, but allocations and arenas are small integer
+// handles (Smis) resolved through state->handles. Nothing on this path
+// creates a V8 heap object, and stale handles resolve to NULL.
+// ==========================================
+
+// JS Usage: rAllocH(size, site_id) -> handle (0 on failure)
+napi_value AllocHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint32_t size_requested;
+    uint32_t site_id = 0;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &size_requested);
+    if (argc > 1) {
+        napi_get_value_uint32(env, args[1], &site_id);
+    }
+
+    void* ptr = r_alloc(size_requested, site_id);
+    handle_t handle = handle_new(state->handles, ptr, HANDLE_BLOCK, HANDLE_NULL);
+    if (ptr && !handle) r_free(ptr); // handle table full
+    else trace_alloc(ptr, size_requested, 0, site_id);
+
+    napi_value output;
+    napi_create_uint32(env, handle, &output);
+    return output;
+}
+
+// JS Usage: rFreeH(handle) -> false if the handle was stale or not from rAllocH
+napi_value FreeHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t handle;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &handle);
+
+    void* ptr = handle_get_kind(state->handles, handle, HANDLE_BLOCK);
+    if (ptr) {
+        detach_views_for_ptr(env, state->views, (uint64_t)ptr);
+        handle_release(state->handles, handle);
+        trace_free(ptr);
+        r_free(ptr);
+    }
+
+    napi_value output;
+    napi_get_boolean(env, ptr != NULL, &output);
+    return output;
+}
+
+// JS Usage: createArenaH(size, policy, max_size, flags) -> arena handle
+napi_value CreateArenaHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    uint32_t size, policy, flags = 0;
+    int64_t max_size = 0;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &size);
+    napi_get_value_uint32(env, args[1], &policy);
+    if (argc > 2) {
+        napi_get_value_int64(env, args[2], &max_size);
+    }
+    if (argc > 3) {
+        napi_get_value_uint32(env, args[3], &flags);
+    }
+
+    arena_t* arena = create_arena_ex(size, (lifetime_t)policy, (size_t)max_size, flags);
+    handle_t handle = handle_new(state->handles, arena, HANDLE_ARENA, HANDLE_NULL);
+    if (arena && !handle) r_destroy(arena);
+    else trace_arena_create(arena, size, policy, (size_t)max_size, flags);
+
+    napi_value output;
+    napi_create_uint32(env, handle, &output);
+    return output;
+}
+
+// JS Usage: rArenaH(arena_handle, size, site_id) -> handle (0 on failure)
+napi_value ArenaAllocHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    uint32_t arena_handle, size;
+    uint32_t site_id = 0;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &arena_handle);
+    napi_get_value_uint32(env, args[1], &size);
+    if (argc > 2) {
+        napi_get_value_uint32(env, args[2], &site_id);
+    }
+
+    handle_t handle = HANDLE_NULL;
+    arena_t* arena = (arena_t*)handle_get_kind(state->handles, arena_handle, HANDLE_ARENA);
+    if (arena) {
+        void* ptr = r_arena(arena, size, site_id);
+        handle = handle_new(state->handles, ptr, HANDLE_SLOT, arena_handle);
+        if (ptr && !handle) r_arena_free(arena, ptr);
+        else trace_arena_alloc(arena, ptr, size, 0, site_id);
+    }
+
+    napi_value output;
+    napi_create_uint32(env, handle, &output);
+    return output;
+}
+
+// JS Usage: rArenaFreeH(arena_handle, handle) -> false if either handle was stale,
+// or `handle` is not an rArenaH allocation of that arena
+napi_value ArenaFreeHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    uint32_t arena_handle, handle;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &arena_handle);
+    napi_get_value_uint32(env, args[1], &handle);
+
+    arena_t* arena = (arena_t*)handle_get_kind(state->handles, arena_handle, HANDLE_ARENA);
+    void* ptr = handle_get_slot(state->handles, handle, arena_handle);
+    bool ok = arena && ptr && r_arena_free(arena, ptr);
+    if (ok) {
+        trace_arena_free(arena, ptr);
+        detach_views_for_ptr(env, state->views, (uint64_t)ptr);
+        handle_release(state->handles, handle);
+    }
+
+    napi_value output;
+    napi_get_boolean(env, ok, &output);
+    return output;
+}
+
+// JS Usage: rResetH(arena_handle) -> every allocation handle of the arena goes stale
+// (false if arena_handle is stale or not an arena)
+napi_value ArenaResetHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t arena_handle;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &arena_handle);
+
+    arena_t* arena = (arena_t*)handle_get_kind(state->handles, arena_handle, HANDLE_ARENA);
+    if (arena) {
+        detach_views_for_arena(env, state->views, (uint64_t)arena);
+        handle_release_owned(state->handles, arena_handle);
+        trace_arena_reset(arena);
+        r_reset(arena);
+    }
+
+    napi_value output;
+    napi_get_boolean(env, arena != NULL, &output);
+    return output;
+}
+
+// JS Usage: rDestroyH(arena_handle) -> false if arena_handle is stale or not an arena
+napi_value DestroyArenaHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t arena_handle;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &arena_handle);
+
+    arena_t* arena = (arena_t*)handle_get_kind(state->handles, arena_handle, HANDLE_ARENA);
+    if (arena) {
+        detach_views_for_arena(env, state->views, (uint64_t)arena);
+        handle_release_owned(state->handles, arena_handle);
+        handle_release(state->handles, arena_handle);
+        trace_arena_destroy(arena);
+        r_destroy(arena);
+    }
+
+    napi_value output;
+    napi_get_boolean(env, arena != NULL, &output);
+    return output;
+}
+
+// Bridges handle mode and the pointer API (e.g. rView / rArenaView)
+// JS Usage: rResolve(handle) -> BigInt pointer (0n if stale)
+napi_value ResolveHandleWrapper(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    uint32_t handle;
+    addon_state_t* state;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, (void**)&state);
+    napi_get_value_uint32(env, args[0], &handle);
+
+    napi_value output;
+    napi_create_bigint_uint64(env, (uint64_t)handle_get(state->handles, handle), &output);
+    return output;
+}
+
+// initialization of function calls
+napi_value Init(napi_env env, napi_value exports) {
+    addon_state_t* state = new addon_state_t;
+    state->views = create_view_registry();
+    state->handles = create_handle_table();
+    state->record_factory = NULL;
+    napi_set_instance_data(env, state, FinalizeAddonState, NULL);
+
+    // R_ALLOC_TRACE=path records every call from the first env that loads us
+    const char* trace_path = getenv("R_ALLOC_TRACE");
+    if (trace_path && *trace_path) trace_start(trace_path);
+
+    napi_value fn_init, fn_alloc, fn_alloc_aligned, fn_free, fn_trim, fn_frag, fn_stats, fn_arena_stats,
+    fn_load_policy, fn_flush_profile, fn_sample_rate, fn_huge_pages, fn_large_threshold, fn_start_trace, fn_stop_trace,
+    fn_arena_init, fn_arena_alloc, fn_arena_aligned, fn_arena_reset, fn_arena_destroy,
+    fn_arena_free, fn_arena_batch, fn_arena_free_batch, fn_arena_mark, fn_arena_rewind,
+    fn_acquire_arena, fn_release_arena, fn_prewarm_arenas, fn_arena_pool_limit, fn_arena_pool_stats,
+    fn_define_struct, fn_create_struct_table, fn_destroy_struct_table, fn_struct_alloc, fn_struct_free,
+    fn_create_hash_table, fn_destroy_hash_table, fn_hash_put, fn_hash_get, fn_hash_delete, fn_hash_sample,
+    fn_hash_count, fn_hash_stats,
+    fn_view, fn_arena_view, fn_alloc_h, fn_free_h, fn_arena_init_h, fn_arena_alloc_h,
+    fn_arena_free_h, fn_arena_reset_h, fn_arena_destroy_h, fn_resolve;
+
+    // export init_heap
+    napi_create_function(env, NULL, 0, InitHeapWrapper, state, &fn_init);
+    napi_set_named_property(env, exports, "init", fn_init);
+
+    // export r_alloc
+    napi_create_function(env, NULL, 0, AllocWrapper, state, &fn_alloc);
+    napi_set_named_property(env, exports, "rAlloc", fn_alloc);
+    //export r_alloc_aligned
+    napi_create_function(env, NULL, 0, AllocAlignedWrapper, state, &fn_alloc_aligned);
+    napi_set_named_property(env, exports, "rAllocAligned", fn_alloc_aligned);
+    // export r_free
+    napi_create_function(env, NULL, 0, FreeWrapper, state, &fn_free);
+    napi_set_named_property(env, exports, "rFree", fn_free);
+    //export r_trim
+    napi_create_function(env, NULL, 0, TrimWrapper, state, &fn_trim);
+    napi_set_named_property(env, exports, "rTrim", fn_trim);
+    napi_set_named_property(env, exports, "rDefrag", fn_trim);
+    //export r_fragmentation
+    napi_create_function(env, NULL, 0, FragmentationWrapper, state, &fn_frag);
+    napi_set_named_property(env, exports, "rFragmentation", fn_frag);
+    //export r_stats
+    napi_create_function(env, NULL, 0, StatsWrapper, state, &fn_stats);
+    napi_set_named_property(env, exports, "rStats", fn_stats);
+    //export r_load_policy
+    napi_create_function(env, NULL, 0, LoadPolicyWrapper, state, &fn_load_policy);
+    napi_set_named_property(env, exports, "loadPolicy", fn_load_policy);
+    //export flush_profiling_data
+    napi_create_function(env, NULL, 0, FlushProfileWrapper, state, &fn_flush_profile);
+    napi_set_named_property(env, exports, "flushProfile", fn_flush_profile);
+    //export r_set_sample_rate
+    napi_create_function(env, NULL, 0, SampleRateWrapper, state, &fn_sample_rate);
+    napi_set_named_property(env, exports, "setSampleRate", fn_sample_rate);
+    //export r_set_huge_pages
+    napi_create_function(env, NULL, 0, HugePagesWrapper, state, &fn_huge_pages);
+    napi_set_named_property(env, exports, "setHugePages", fn_huge_pages);
+    //export r_set_large_threshold
+    napi_create_function(env, NULL, 0, LargeThresholdWrapper, state, &fn_large_threshold);
+    napi_set_named_property(env, exports, "setLargeThreshold", fn_large_threshold);
+    //export trace_start / trace_stop
+    napi_create_function(env, NULL, 0, StartTraceWrapper, state, &fn_start_trace);
+    napi_set_named_property(env, exports, "startTrace", fn_start_trace);
+    napi_create_function(env, NULL, 0, StopTraceWrapper, state, &fn_stop_trace);
+    napi_set_named_property(env, exports, "stopTrace", fn_stop_trace);
+    //export arena_init
+    napi_create_function(env, NULL, 0, CreateArenaWrapper, state, &fn_arena_init);
+    napi_set_named_property(env, exports, "createArena", fn_arena_init);
+    //export arena_alloc
+    napi_create_function(env, NULL, 0, ArenaAllocWrapper, state, &fn_arena_alloc);
+    napi_set_named_property(env, exports, "rArena", fn_arena_alloc);
+    //export r_arena_aligned
+    napi_create_function(env, NULL, 0, ArenaAllocAlignedWrapper, state, &fn_arena_aligned);
+    napi_set_named_property(env, exports, "rArenaAligned", fn_arena_aligned);
+    //export arena_reset
+    napi_create_function(env, NULL, 0, ArenaResetWrapper, state, &fn_arena_reset);
+    napi_set_named_property(env, exports, "rReset", fn_arena_reset);
+
+    napi_create_function(env, NULL, 0, DestroyArenaWrapper, state, &fn_arena_destroy);
+    napi_set_named_property(env, exports, "rDestroy", fn_arena_destroy);
+
+    napi_create_function(env, NULL, 0, ArenaFreeWrapper, state, &fn_arena_free);
+    napi_set_named_property(env, exports, "rArenaFree", fn_arena_free);
+    //export the arena pool
+    napi_create_function(env, NULL, 0, AcquireArenaWrapper, state, &fn_acquire_arena);
+    napi_set_named_property(env, exports, "acquireArena", fn_acquire_arena);
+    napi_create_function(env, NULL, 0, ReleaseArenaWrapper, state, &fn_release_arena);
+    napi_set_named_property(env, exports, "releaseArena", fn_release_arena);
+    napi_create_function(env, NULL, 0, PrewarmArenasWrapper, state, &fn_prewarm_arenas);
+    napi_set_named_property(env, exports, "prewarmArenas", fn_prewarm_arenas);
+    napi_create_function(env, NULL, 0, ArenaPoolLimitWrapper, state, &fn_arena_pool_limit);
+    napi_set_named_property(env, exports, "setArenaPoolLimit", fn_arena_pool_limit);
+    napi_create_function(env, NULL, 0, ArenaPoolStatsWrapper, state, &fn_arena_pool_stats);
+    napi_set_named_property(env, exports, "arenaPoolStats", fn_arena_pool_stats);
+
+    napi_create_function(env, NULL, 0, ArenaAllocBatchWrapper, state, &fn_arena_batch);
+    napi_set_named_property(env, exports, "rArenaBatch", fn_arena_batch);
+
+    napi_create_function(env, NULL, 0, ArenaFreeBatchWrapper, state, &fn_arena_free_batch);
+    napi_set_named_property(env, exports, "rArenaFreeBatch", fn_arena_free_batch);
+
+    napi_create_function(env, NULL, 0, ArenaMarkWrapper, state, &fn_arena_mark);
+    napi_set_named_property(env, exports, "rArenaMark", fn_arena_mark);
+
+    napi_create_function(env, NULL, 0, ArenaRewindWrapper, state, &fn_arena_rewind);
+    napi_set_named_property(env, exports, "rArenaRewind", fn_arena_rewind);
+    //export r_arena_stats
+    napi_create_function(env, NULL, 0, ArenaStatsWrapper, state, &fn_arena_stats);
+    napi_set_named_property(env, exports, "rArenaStats", fn_arena_stats);
+
+    napi_create_function(env, NULL, 0, ViewWrapper, state, &fn_view);
+    napi_set_named_property(env, exports, "rView", fn_view);
+
+    napi_create_function(env, NULL, 0, ArenaViewWrapper, state, &fn_arena_view);
+    napi_set_named_property(env, exports, "rArenaView", fn_arena_view);
+
+    // structs
+    napi_create_function(env, NULL, 0, DefineStructWrapper, state, &fn_define_struct);
+    napi_set_named_property(env, exports, "defineStruct", fn_define_struct);
+    napi_create_function(env, NULL, 0, CreateStructTableWrapper, state, &fn_create_struct_table);
+    napi_set_named_property(env, exports, "createStructTable", fn_create_struct_table);
+    napi_create_function(env, NULL, 0, DestroyStructTableWrapper, state, &fn_destroy_struct_table);
+    napi_set_named_property(env, exports, "destroyStructTable", fn_destroy_struct_table);
+    napi_create_function(env, NULL, 0, StructAllocWrapper, state, &fn_struct_alloc);
+    napi_set_named_property(env, exports, "structAlloc", fn_struct_alloc);
+    napi_create_function(env, NULL, 0, StructFreeWrapper, state, &fn_struct_free);
+    napi_set_named_property(env, exports, "structFree", fn_struct_free);
+
+    // hash tables
+    napi_create_function(env, NULL, 0, CreateHashTableWrapper, state, &fn_create_hash_table);
+    napi_set_named_property(env, exports, "createHashTable", fn_create_hash_table);
+    napi_create_function(env, NULL, 0, DestroyHashTableWrapper, state, &fn_destroy_hash_table);
+    napi_set_named_property(env, exports, "destroyHashTable", fn_destroy_hash_table);
+    napi_create_function(env, NULL, 0, HashPutWrapper, state, &fn_hash_put);
+    napi_set_named_property(env, exports, "hashPut", fn_hash_put);
+    napi_create_function(env, NULL, 0, HashGetWrapper, state, &fn_hash_get);
+    napi_set_named_property(env, exports, "hashGet", fn_hash_get);
+    napi_create_function(env, NULL, 0, HashDeleteWrapper, state, &fn_hash_delete);
+    napi_set_named_property(env, exports, "hashDelete", fn_hash_delete);
+    napi_create_function(env, NULL, 0, HashSampleWrapper, state, &fn_hash_sample);
+    napi_set_named_property(env, exports, "hashSample", fn_hash_sample);
+    napi_create_function(env, NULL, 0, HashCountWrapper, state, &fn_hash_count);
+    napi_set_named_property(env, exports, "hashCount", fn_hash_count);
+    napi_create_function(env, NULL, 0, HashStatsWrapper, state, &fn_hash_stats);
+    napi_set_named_property(env, exports, "hashStats", fn_hash_stats);
+
+    // handle mode
+    napi_create_function(env, NULL, 0, AllocHandleWrapper, state, &fn_alloc_h);
+    napi_set_named_property(env, exports, "rAllocH", fn_alloc_h);
+    napi_create_function(env, NULL, 0, FreeHandleWrapper, state, &fn_free_h);
+    napi_set_named_property(env, exports, "rFreeH", fn_free_h);
+    napi_create_function(env, NULL, 0, CreateArenaHandleWrapper, state, &fn_arena_init_h);
+    napi_set_named_property(env, exports, "createArenaH", fn_arena_init_h);
+    napi_create_function(env, NULL, 0, ArenaAllocHandleWrapper, state, &fn_arena_alloc_h);
+    napi_set_named_property(env, exports, "rArenaH", fn_arena_alloc_h);
+    napi_create_function(env, NULL, 0, ArenaFreeHandleWrapper, state, &fn_arena_free_h);
+    napi_set_named_property(env, exports, "rArenaFreeH", fn_arena_free_h);
+    napi_create_function(env, NULL, 0, ArenaResetHandleWrapper, state, &fn_arena_reset_h);
+    napi_set_named_property(env, exports, "rResetH", fn_arena_reset_h);
+    napi_create_function(env, NULL, 0, DestroyArenaHandleWrapper, state, &fn_arena_destroy_h);
+    napi_set_named_property(env, exports, "rDestroyH", fn_arena_destroy_h);
+    napi_create_function(env, NULL, 0, ResolveHandleWrapper, state, &fn_resolve);
+    napi_set_named_property(env, exports, "rResolve", fn_resolve);
     return exports;
 }
 
@@ -3,21 +3,77 @@
 #include <sys/mman.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <map>
+#include <string.h>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 #include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
-#define HEAP_SIZE (64 * 1024 * 1024)
+#define HEAP_SIZE (64 * 1024 * 1024)          // default segment size
+#define HEAP_MAX_SIZE (1024ULL * 1024 * 1024)  // default hard cap
+#define PAGE_SIZE 4096
 
 // --- PROFILING STATE ---
+// Only sampled blocks are tracked (the block header carries a flag). Their
+// birth records sit in a fixed open-addressing table keyed by pointer, and
+// their deaths go through a lock-free ring that a background thread drains
+// into training_data.bin. The allocating thread never takes a lock, never
+// allocates and never touches the file.
+#define SAMPLE_TABLE_SIZE (1 << 20)
+#define SAMPLE_PROBE_LIMIT 32
+#define SAMPLE_EMPTY 0
+#define SAMPLE_TOMBSTONE 1
+#define SAMPLE_BUSY 2        // claimed, record not written yet
+#define RING_SIZE (1 << 16)
+#define FLUSH_INTERVAL_MS 10
+#define PROFILE_MAGIC 0x46525052 // "RPRF"
+#define PROFILE_VERSION 1
+
 struct AllocationMeta {
-    uint64_t start_time;
+    uintptr_t ptr;        // SAMPLE_EMPTY/TOMBSTONE/BUSY or the payload address
+    uint64_t start_ticks;
     uint32_t site_id;
     size_t size;
 };
 
-// The Shadow Map: Ptr -> Metadata
-std::map<void*, AllocationMeta> shadow_map;
+// training_data.bin: one ProfileHeader, then ProfileRecords back to back
+struct ProfileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t sample_rate;  // at the time the file was opened
+};
+
+struct ProfileRecord {
+    uint32_t site_id;
+    uint32_t live;         // 1 = still allocated when flushed
+    uint64_t size;
+    uint64_t lifespan_ns;  // holds raw ticks until the flusher converts it
+};
+
+struct RingSlot {
+    uint64_t seq;          // == position when free, position + 1 when filled
+    ProfileRecord record;
+};
+
+AllocationMeta *sample_table = NULL;
+RingSlot *ring = NULL;
+uint64_t ring_tail = 0;     // producers (CAS)
+uint64_t ring_head = 0;     // consumer, under profile_lock
+uint64_t profile_dropped = 0;
+uint32_t sample_rate = SAMPLE_RATE_DEFAULT; // 1 = every allocation, N = about 1 in N, 0 = off
+static thread_local uint32_t sample_countdown = 0;
+static thread_local uint32_t sample_rng = 0;
+
 FILE *log_file = NULL;
+std::mutex profile_lock; // guards log_file and the consumer side of the ring
+std::condition_variable flusher_wake;
+uint64_t ticks_origin = 0;
+uint64_t nanos_origin = 0;
 
 // Helper: Get nanoseconds
 uint64_t get_nanos() {
@@ -26,87 +82,1143 @@ uint64_t get_nanos() {
     return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
+// Cheap timestamp for the hot path: the TSC where we have one. The flusher
+// converts ticks to nanoseconds against get_nanos().
+static inline uint64_t get_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return get_nanos();
+#endif
+}
+
 // --- ALLOCATOR STATE ---
+// Boundary tags: every block starts with a header, and a FREE block also
+// ends with a footer holding its size. `prev_free` tells us whether the
+// block right before us is free, so r_free can find and merge both
+// neighbours in O(1) without walking the heap.
 struct Block {
     size_t size;
-    int free;
-    struct Block *next;
+    uint16_t free;      // BLOCK_USED, BLOCK_FREE or BLOCK_TCACHED
+    uint16_t sampled;   // PROFILING: birth record is in sample_table
+    uint16_t prev_free;
+    uint16_t zone;      // index into zones[], fixed for the life of the segment
+};
+
+#define BLOCK_USED 0
+#define BLOCK_FREE 1     // in a bin
+#define BLOCK_TCACHED 2  // in a thread cache: used to the backend, free to callers
+
+// Free blocks keep their bin links in the (otherwise unused) payload
+struct FreeLinks {
+    Block *prev;
+    Block *next;
+};
+
+// Payloads start 16 bytes into a block and sizes are multiples of 16, so
+// every payload is 16-byte aligned, like malloc's
+#define ALIGNMENT 16
+#define MIN_PAYLOAD (sizeof(FreeLinks) + sizeof(size_t)) // links + footer
+#define MAX_ALIGN PAGE_SIZE // r_alloc_aligned limit
+
+// --- SIZE-CLASS BINS ---
+// Segregated fit: below SMALL_BIN_LIMIT every bin holds exactly one size
+// (ALIGNMENT spacing). Above it each power of two is split into SUB_BIN_COUNT
+// bins. A bitmap over the bins lets us find the first non-empty bin that
+// can satisfy a request with a couple of ctz instructions instead of
+// walking every block on the heap.
+#define SMALL_BIN_LIMIT 512
+#define SMALL_BIN_SHIFT 9 // log2(SMALL_BIN_LIMIT)
+#define SMALL_BIN_COUNT (SMALL_BIN_LIMIT / ALIGNMENT)
+#define SUB_BIN_BITS 2
+#define SUB_BIN_COUNT (1 << SUB_BIN_BITS)
+#define MAX_BIN_SHIFT 48
+#define BIN_COUNT (SMALL_BIN_COUNT + (MAX_BIN_SHIFT - SMALL_BIN_SHIFT) * SUB_BIN_COUNT)
+#define BITMAP_WORDS ((BIN_COUNT + 63) / 64)
+
+// --- SEGMENTS ---
+// The heap is a list of mmap'd segments. Each one is laid out as
+//   [ blocks ... | epilogue Block | Segment trailer ]
+// Keeping the descriptor at the END means the epilogue of a free block's
+// segment leads us straight to it, so r_free can tell when a segment has
+// become completely free and unmap it.
+struct Segment {
+    struct Segment *next;
+    struct Segment *prev;
+    size_t size;         // total mapped bytes, trailer included
+    Block *first;        // first block in the segment
+};
+
+Segment *segments = NULL;
+size_t segment_count = 0;
+size_t mapped_bytes = 0;
+size_t segment_size = HEAP_SIZE;
+size_t heap_max_size = HEAP_MAX_SIZE;
+
+// Huge page backing (opt-in, fixed before the first segment is mapped).
+// Segments are then multiples of HUGE_PAGE_SIZE and start on a 2MB
+// boundary, so every page of them can be a huge page.
+int huge_pages = HUGE_PAGES_OFF;
+size_t huge_fallbacks = 0; // MAP_HUGETLB maps that fell back to THP
+
+// --- LIFETIME ZONES ---
+// Every zone has its own bins and its own segments. Untrained call sites
+// (and sites trained as PERSISTENT) use the default zone. With a policy
+// loaded, short-lived sites get zones of their own, so their churn cannot
+// leave holes between long-lived blocks.
+#define ZONE_DEFAULT 0
+#define ZONE_TRANSIENT 1
+#define ZONE_INTERMEDIATE 2
+#define ZONE_COUNT 3
+
+struct Zone {
+    Block *bins[BIN_COUNT];
+    uint64_t bin_bitmap[BITMAP_WORDS];
+    size_t free_bytes;     // payload bytes currently sitting in bins
+    size_t free_blocks;
+    size_t segment_count;
+};
+
+// Guards the bins and the segment list. Threads only take it when their
+// thread cache needs a refill/flush, or for blocks above TCACHE_MAX_SIZE.
+std::mutex heap_lock;
+
+#define TCACHE_MAX_SIZE 1024
+#define TCACHE_CLASSES (TCACHE_MAX_SIZE / ALIGNMENT + 1)
+#define TCACHE_BATCH 32
+#define TCACHE_LIMIT (2 * TCACHE_BATCH)
+
+struct ThreadCache {
+    Block *lists[ZONE_COUNT][TCACHE_CLASSES];
+    uint32_t counts[ZONE_COUNT][TCACHE_CLASSES];
+    ~ThreadCache(); // hands everything back when the thread exits
+};
+
+Zone zones[ZONE_COUNT];
+Block *trim_cursor = NULL;
+
+// Payload bytes the backend has handed out (under heap_lock). Blocks
+// parked in thread caches count as used: only their thread can see them.
+size_t used_bytes = 0;
+size_t peak_used_bytes = 0;
+
+// --- LARGE OBJECTS ---
+// Requests of at least large_threshold bytes are mapped on their own:
+//   [ LargeHeader | Block | payload ... ]
+// The Block is an ordinary used header tagged ZONE_LARGE, so r_free can
+// tell them apart and unmap the whole mapping instead of binning it.
+#define ZONE_LARGE 0xffff
+
+struct LargeHeader {
+    void *base;    // start of the mapping
+    size_t mapped; // its length
+};
+
+size_t large_threshold = LARGE_THRESHOLD; // 0 = off
+size_t large_count = 0;
+size_t large_bytes = 0; // mapped for large objects (part of mapped_bytes)
+
+// --- LIFETIME POLICY ---
+// Per-site routing built offline by scripts/train_policy.js. Open
+// addressing keyed by site_id (0 = untagged, doubles as the empty marker).
+struct SitePolicy {
+    uint32_t site_id;
+    uint32_t zone;
+    size_t size_class;  // requests up to this size are rounded up to it (0 = off)
+};
+
+struct PolicyTable {
+    size_t mask;
+    SitePolicy *slots;
 };
 
-Block *free_list = NULL;
-void *heap_start = NULL;
+// Published with an atomic store and never freed: allocating threads may
+// still be probing an older table when a new one is loaded.
+PolicyTable *policy = NULL;
+
+static inline FreeLinks* links(Block *block) {
+    return (FreeLinks*)((char*)block + sizeof(Block));
+}
+
+static inline Block* next_block(Block *block) {
+    return (Block*)((char*)block + sizeof(Block) + block->size);
+}
+
+// Only valid when block->prev_free is set (the footer exists)
+static inline Block* prev_block(Block *block) {
+    size_t prev_size = *((size_t*)block - 1);
+    return (Block*)((char*)block - prev_size - sizeof(Block));
+}
+
+static inline void write_footer(Block *block) {
+    *(size_t*)((char*)next_block(block) - sizeof(size_t)) = block->size;
+}
+
+// Bin that a block of exactly `size` bytes lives in
+static inline int bin_index(size_t size) {
+    if (size < SMALL_BIN_LIMIT) return (int)(size / ALIGNMENT);
+    int fl = 63 - __builtin_clzll(size);
+    int sl = (int)(size >> (fl - SUB_BIN_BITS)) & (SUB_BIN_COUNT - 1);
+    int index = SMALL_BIN_COUNT + (fl - SMALL_BIN_SHIFT) * SUB_BIN_COUNT + sl;
+    return index < BIN_COUNT ? index : BIN_COUNT - 1;
+}
+
+// First bin whose blocks are ALL large enough for `size`
+static inline int bin_index_fit(size_t size) {
+    if (size < SMALL_BIN_LIMIT) return bin_index(size);
+    int fl = 63 - __builtin_clzll(size);
+    return bin_index(size + ((size_t)1 << (fl - SUB_BIN_BITS)) - 1);
+}
+
+static void bin_insert(Block *block) {
+    Zone *z = &zones[block->zone];
+    int index = bin_index(block->size);
+    FreeLinks *l = links(block);
+    l->prev = NULL;
+    l->next = z->bins[index];
+    if (z->bins[index]) links(z->bins[index])->prev = block;
+    z->bins[index] = block;
+    z->bin_bitmap[index / 64] |= 1ULL << (index % 64);
+    z->free_bytes += block->size;
+    z->free_blocks++;
+}
+
+static void bin_remove(Block *block) {
+    Zone *z = &zones[block->zone];
+    int index = bin_index(block->size);
+    FreeLinks *l = links(block);
+    if (l->prev) links(l->prev)->next = l->next;
+    else z->bins[index] = l->next;
+    if (l->next) links(l->next)->prev = l->prev;
+    if (!z->bins[index]) z->bin_bitmap[index / 64] &= ~(1ULL << (index % 64));
+    z->free_bytes -= block->size;
+    z->free_blocks--;
+}
+
+// Lowest non-empty bin >= index, or -1
+static int next_nonempty_bin(Zone *z, int index) {
+    int word = index / 64;
+    uint64_t bits = z->bin_bitmap[word] & (~0ULL << (index % 64));
+    while (!bits) {
+        if (++word == BITMAP_WORDS) return -1;
+        bits = z->bin_bitmap[word];
+    }
+    return word * 64 + __builtin_ctzll(bits);
+}
+
+static Block* find_free_block(Zone *z, size_t size) {
+    int index = next_nonempty_bin(z, bin_index_fit(size));
+    if (index != -1) return z->bins[index];
+
+    // Last resort: the request's own bin may still hold a block that fits
+    for (Block *b = z->bins[bin_index(size)]; b; b = links(b)->next) {
+        if (b->size >= size) return b;
+    }
+    return NULL;
+}
+
+// Only valid for an epilogue block
+static inline Segment* segment_of(Block *epilogue) {
+    return (Segment*)((char*)epilogue + sizeof(Block));
+}
+
+// Maps `size` bytes (a HUGE_PAGE_SIZE multiple in huge page mode) with the
+// current backing. MAP_HUGETLB needs pages reserved in
+// /proc/sys/vm/nr_hugepages; when there are none we fall back to THP.
+static void* map_pages(size_t size) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (huge_pages == HUGE_PAGES_HUGETLB) {
+        void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) return base;
+        if (huge_fallbacks++ == 0) {
+            fprintf(stderr, "r_alloc: MAP_HUGETLB failed, falling back to transparent huge pages\n");
+        }
+    }
+    if (huge_pages == HUGE_PAGES_OFF) {
+        void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        return base == MAP_FAILED ? NULL : base;
+    }
+
+    // THP: over-map by one huge page and trim both ends to a 2MB boundary
+    char *raw = (char*)mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char *base = (char*)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (base > raw) munmap(raw, base - raw);
+    munmap(base + size, raw + HUGE_PAGE_SIZE - base);
+#ifdef MADV_HUGEPAGE
+    madvise(base, size, MADV_HUGEPAGE); // best effort: THP may be disabled
+#endif
+    return base;
+}
+
+// Rounds a mapping size to what map_pages() can hand out
+static inline size_t page_round(size_t size) {
+    size_t unit = huge_pages ? HUGE_PAGE_SIZE : PAGE_SIZE;
+    return (size + unit - 1) & ~(unit - 1);
+}
+
+// Whether mapping `bytes` more stays under the cap (no sum that could wrap)
+static inline int within_cap(size_t bytes) {
+    return bytes <= heap_max_size && mapped_bytes <= heap_max_size - bytes;
+}
+
+// Largest request whose rounding cannot wrap size_t, whichever path adds
+// its headers: large_alloc (header or alignment, then a huge page of
+// rounding), heap_alloc_aligned (alignment and a lead block) or grow_heap
+// (segment header and epilogue, then rounding)
+#define MAX_REQUEST_SIZE (SIZE_MAX - (sizeof(Segment) + sizeof(LargeHeader) + 3 * sizeof(Block) + \
+                                      2 * MAX_ALIGN + MIN_PAYLOAD + HUGE_PAGE_SIZE))
+
+static Segment* map_segment(int zone, size_t size) {
+    void *base = map_pages(size);
+    if (!base) {
+        perror("mmap failed");
+        return NULL;
+    }
+
+    Segment *seg = (Segment*)((char*)base + size - sizeof(Segment));
+    seg->size = size;
+    seg->first = (Block*)base;
+    seg->prev = NULL;
+    seg->next = segments;
+    if (segments) segments->prev = seg;
+    segments = seg;
+    segment_count++;
+    zones[zone].segment_count++;
+    mapped_bytes += size;
+
+    Block *block = seg->first;
+    block->size = size - sizeof(Segment) - 2 * sizeof(Block);
+    block->free = 1;
+    block->prev_free = 0;
+    block->zone = zone;
+    write_footer(block);
+    bin_insert(block);
+
+    // Epilogue: a zero-sized, always-used block so coalescing stops at the end
+    Block *epilogue = next_block(block);
+    epilogue->size = 0;
+    epilogue->free = 0;
+    epilogue->prev_free = 1;
+    epilogue->zone = zone;
+    return seg;
+}
+
+// Unmaps the segment if `block` (free, already coalesced) now spans all of
+// it. The last remaining segment of each zone is kept so steady-state churn
+// does not keep mapping and unmapping. Returns 1 if the segment is gone.
+static int release_segment_if_empty(Block *block, int binned) {
+    Block *epilogue = next_block(block);
+    if (epilogue->size != 0) return 0;
+    Segment *seg = segment_of(epilogue);
+    if (seg->first != block || zones[block->zone].segment_count == 1) return 0;
+
+    if (binned) bin_remove(block);
+    if (trim_cursor && (char*)trim_cursor >= (char*)seg->first &&
+        (char*)trim_cursor < (char*)seg) {
+        trim_cursor = seg->next ? seg->next->first : segments->first;
+        if (trim_cursor == block) trim_cursor = NULL;
+    }
+    if (seg->prev) seg->prev->next = seg->next;
+    else segments = seg->next;
+    if (seg->next) seg->next->prev = seg->prev;
+    segment_count--;
+    zones[block->zone].segment_count--;
+    mapped_bytes -= seg->size;
+    munmap(seg->first, seg->size);
+    return 1;
+}
+
+// Maps a new segment big enough for a `size` byte payload, within the cap
+static int grow_heap(int zone, size_t size) {
+    size_t needed = page_round(size + sizeof(Segment) + 2 * sizeof(Block));
+    size_t bytes = needed > segment_size ? needed : segment_size;
+
+    if (!within_cap(bytes)) {
+        // Fall back to an exact-fit segment if a full one would cross the cap
+        if (!within_cap(needed)) return 0;
+        bytes = needed;
+    }
+    return map_segment(zone, bytes) != NULL;
+}
+
+// --- PROFILING ---
+static inline size_t sample_hash(uintptr_t ptr) {
+    return (size_t)(((ptr >> 4) * 0x9E3779B97F4A7C15ULL) >> 44) & (SAMPLE_TABLE_SIZE - 1);
+}
+
+// Every allocation at rate 1, otherwise gaps drawn uniformly from
+// [1, 2 * rate - 1] so the mean is `rate` without aliasing on loops.
+// While sampling is off (or init_heap has not run) the thread waits
+// SAMPLE_RATE_DEFAULT allocations before it looks again.
+static int sample_next() {
+    uint32_t rate = __atomic_load_n(&sample_rate, __ATOMIC_RELAXED);
+    if (!sample_table || rate == 0) {
+        sample_countdown = SAMPLE_RATE_DEFAULT;
+        return 0;
+    }
+    if (rate == 1) return 1;
+    if (!sample_rng) sample_rng = (uint32_t)(uintptr_t)&sample_rng | 1;
+    sample_rng ^= sample_rng << 13;
+    sample_rng ^= sample_rng >> 17;
+    sample_rng ^= sample_rng << 5;
+    sample_countdown = 1 + sample_rng % (2 * rate - 1);
+    return 1;
+}
+
+// The allocation fast path only touches this thread's countdown
+static inline int should_sample() {
+    if (__builtin_expect(sample_countdown > 1, 1)) {
+        sample_countdown--;
+        return 0;
+    }
+    return sample_next();
+}
+
+// Claims a slot (EMPTY or TOMBSTONE -> BUSY), fills it, then publishes the
+// key. Returns 0 if no slot is free within the probe limit; the block is
+// simply not sampled then.
+static int sample_insert(void *ptr, uint32_t site_id, size_t size) {
+    size_t i = sample_hash((uintptr_t)ptr);
+    for (int probe = 0; probe < SAMPLE_PROBE_LIMIT; probe++) {
+        AllocationMeta *slot = &sample_table[i];
+        uintptr_t key = __atomic_load_n(&slot->ptr, __ATOMIC_RELAXED);
+        if (key <= SAMPLE_TOMBSTONE &&
+            __atomic_compare_exchange_n(&slot->ptr, &key, (uintptr_t)SAMPLE_BUSY,
+                                        false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            slot->start_ticks = get_ticks();
+            slot->site_id = site_id;
+            slot->size = size;
+            __atomic_store_n(&slot->ptr, (uintptr_t)ptr, __ATOMIC_RELEASE);
+            return 1;
+        }
+        i = (i + 1) & (SAMPLE_TABLE_SIZE - 1);
+    }
+    return 0;
+}
+
+// Producer side of a bounded MPSC ring (per-slot sequence numbers). When
+// the flusher falls behind the record is dropped and counted, never waited on.
+static void ring_push(const ProfileRecord *record) {
+    uint64_t pos = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+    for (;;) {
+        RingSlot *slot = &ring[pos & (RING_SIZE - 1)];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq == pos) {
+            if (__atomic_compare_exchange_n(&ring_tail, &pos, pos + 1,
+                                            true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                slot->record = *record;
+                __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+                // Exactly one producer per lap sees the ring cross half
+                // full and wakes the flusher early
+                if (pos - __atomic_load_n(&ring_head, __ATOMIC_RELAXED) == RING_SIZE / 2) {
+                    flusher_wake.notify_one();
+                }
+                return;
+            }
+        } else if (seq < pos) {
+            __atomic_fetch_add(&profile_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Moves a sampled block's birth record into the ring as a death record
+static void sample_remove(void *ptr) {
+    uint64_t now = get_ticks();
+    size_t i = sample_hash((uintptr_t)ptr);
+    for (int probe = 0; probe < SAMPLE_PROBE_LIMIT; probe++) {
+        AllocationMeta *slot = &sample_table[i];
+        uintptr_t key = __atomic_load_n(&slot->ptr, __ATOMIC_ACQUIRE);
+        if (key == SAMPLE_EMPTY) return;
+        if (key == (uintptr_t)ptr) {
+            ProfileRecord record;
+            record.site_id = slot->site_id;
+            record.live = 0;
+            record.size = slot->size;
+            record.lifespan_ns = now - slot->start_ticks;
+            __atomic_store_n(&slot->ptr, (uintptr_t)SAMPLE_TOMBSTONE, __ATOMIC_RELEASE);
+            ring_push(&record);
+            return;
+        }
+        i = (i + 1) & (SAMPLE_TABLE_SIZE - 1);
+    }
+}
+
+// TSC rate measured over the whole run so far
+static double ticks_per_ns() {
+    double nanos = (double)(get_nanos() - nanos_origin);
+    return nanos > 0 ? (double)(get_ticks() - ticks_origin) / nanos : 1.0;
+}
+
+// Caller holds profile_lock. Opens the file on first use and converts
+// ticks to nanoseconds.
+static void write_record(ProfileRecord *record, double tick_rate) {
+    if (!log_file) {
+        log_file = fopen("training_data.bin", "wb");
+        if (!log_file) return;
+        ProfileHeader header;
+        header.magic = PROFILE_MAGIC;
+        header.version = PROFILE_VERSION;
+        header.record_size = sizeof(ProfileRecord);
+        header.sample_rate = __atomic_load_n(&sample_rate, __ATOMIC_RELAXED);
+        fwrite(&header, sizeof(header), 1, log_file);
+    }
+    record->lifespan_ns = (uint64_t)((double)record->lifespan_ns / tick_rate);
+    fwrite(record, sizeof(ProfileRecord), 1, log_file);
+}
+
+// Consumer side of the ring, caller holds profile_lock
+static void ring_drain() {
+    double tick_rate = ticks_per_ns();
+    for (;;) {
+        RingSlot *slot = &ring[ring_head & (RING_SIZE - 1)];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ring_head + 1) break;
+        ProfileRecord record = slot->record;
+        __atomic_store_n(&slot->seq, ring_head + RING_SIZE, __ATOMIC_RELEASE);
+        __atomic_store_n(&ring_head, ring_head + 1, __ATOMIC_RELAXED);
+        write_record(&record, tick_rate);
+    }
+}
+
+// Background flusher. The static instance stops and joins the thread at
+// exit, after one last drain, so a training run loses nothing on the way out.
+struct ProfileFlusher {
+    std::thread thread;
+    bool stop = false;
+
+    void run() {
+        std::unique_lock<std::mutex> guard(profile_lock);
+        while (!stop) {
+            flusher_wake.wait_for(guard, std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+            ring_drain();
+        }
+        ring_drain();
+        if (log_file) {
+            fclose(log_file);
+            log_file = NULL;
+        }
+        uint64_t dropped = __atomic_load_n(&profile_dropped, __ATOMIC_RELAXED);
+        if (dropped) fprintf(stderr, "r_alloc profiling: dropped %lu records\n", (unsigned long)dropped);
+    }
+
+    ~ProfileFlusher() {
+        if (!thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> guard(profile_lock);
+            stop = true;
+        }
+        flusher_wake.notify_one();
+        thread.join();
+    }
+};
+
+static ProfileFlusher flusher;
+
+static void init_profiling() {
+    const char *rate = getenv("R_ALLOC_SAMPLE_RATE");
+    if (rate && *rate) sample_rate = (uint32_t)strtoul(rate, NULL, 10);
+
+    sample_table = (AllocationMeta*)mmap(NULL, SAMPLE_TABLE_SIZE * sizeof(AllocationMeta),
+                                         PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring = (RingSlot*)mmap(NULL, RING_SIZE * sizeof(RingSlot),
+                           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (sample_table == MAP_FAILED || ring == MAP_FAILED) {
+        perror("mmap failed");
+        sample_table = NULL;
+        sample_rate = 0;
+        return;
+    }
+    for (uint64_t i = 0; i < RING_SIZE; i++) ring[i].seq = i;
+
+    ticks_origin = get_ticks();
+    nanos_origin = get_nanos();
+    flusher.thread = std::thread(&ProfileFlusher::run, &flusher);
+}
 
 void init_heap() {
+    init_heap_config(HEAP_SIZE, HEAP_MAX_SIZE);
+}
+
+int init_heap_config(size_t seg_size, size_t max_size) {
+    if (seg_size < PAGE_SIZE || seg_size > MAX_REQUEST_SIZE) return 0;
+    // Every worker_threads worker loads the addon and calls init()
+    std::lock_guard<std::mutex> guard(heap_lock);
+    if (segments) return 1; // already initialized
+
     // 1. Setup Heap
-    heap_start = mmap(NULL, HEAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    free_list = (Block*)heap_start;
-    free_list->size = HEAP_SIZE - sizeof(Block);
-    free_list->free = 1;
-    free_list->next = NULL;
+    const char *huge_env = getenv("R_ALLOC_HUGE_PAGES");
+    if (huge_env && !strcmp(huge_env, "thp")) huge_pages = HUGE_PAGES_THP;
+    if (huge_env && !strcmp(huge_env, "hugetlb")) huge_pages = HUGE_PAGES_HUGETLB;
+    const char *large_env = getenv("R_ALLOC_LARGE_THRESHOLD");
+    if (large_env && *large_env) r_set_large_threshold(strtoull(large_env, NULL, 10));
+    segment_size = page_round(seg_size);
+    if (max_size == 0) max_size = HEAP_MAX_SIZE;
+    heap_max_size = max_size < segment_size ? segment_size : max_size;
+    if (!map_segment(ZONE_DEFAULT, segment_size)) return 0;
 
-    // 2. Setup Logging (If Profiling)
+    // 2. Setup Sampling (If Profiling)
     if (PROFILING_MODE) {
-        log_file = fopen("training_data.csv", "w");
-        if (log_file) {
-            fprintf(log_file, "site_id,size,lifespan_ns\n");
-            printf("--- PROFILING MODE ENABLED: Logging to training_data.csv ---\n");
-        }
+        init_profiling();
     }
+
+    // 3. Load the trained lifetime policy (If Any)
+    const char *policy_path = getenv("R_ALLOC_POLICY");
+    if (policy_path && *policy_path) {
+        size_t sites = r_load_policy(policy_path);
+        printf("--- LIFETIME POLICY: %zu sites loaded from %s ---\n", sites, policy_path);
+    }
+    return 1;
 }
 
-void* r_alloc(size_t size, uint32_t site_id) {
-    Block *current = free_list;
-    while (current) {
-        if (current->free && current->size >= size) {
-            // Split logic (Simplified for brevity)
-            if (current->size > size + sizeof(Block) + 32) {
-                Block *new_block = (Block*)((char*)current + sizeof(Block) + size);
-                new_block->size = current->size - size - sizeof(Block);
-                new_block->free = 1;
-                new_block->next = current->next;
-                current->size = size;
-                current->next = new_block;
-            }
-            current->free = 0;
-            
-            void* ptr = (void*)((char*)current + sizeof(Block));
-
-            // --- PROFILING: Record Birth ---
-            if (PROFILING_MODE) {
-                AllocationMeta meta;
-                meta.start_time = get_nanos();
-                meta.site_id = site_id;
-                meta.size = size;
-                shadow_map[ptr] = meta;
+// --- BACKEND (caller holds heap_lock) ---
+static Block* heap_alloc(int zone, size_t size) {
+    Zone *z = &zones[zone];
+    Block *current = find_free_block(z, size);
+    if (!current) {
+        if (!grow_heap(zone, size)) return NULL;
+        current = find_free_block(z, size);
+        if (!current) return NULL;
+    }
+    bin_remove(current);
+
+    // Split off the tail if it is big enough to be a block of its own
+    if (current->size >= size + sizeof(Block) + MIN_PAYLOAD) {
+        Block *new_block = (Block*)((char*)current + sizeof(Block) + size);
+        new_block->size = current->size - size - sizeof(Block);
+        new_block->free = 1;
+        new_block->prev_free = 0;
+        new_block->zone = current->zone;
+        current->size = size;
+        write_footer(new_block);
+        bin_insert(new_block);
+    } else {
+        next_block(current)->prev_free = 0;
+    }
+    current->free = 0;
+    used_bytes += current->size;
+    if (used_bytes > peak_used_bytes) peak_used_bytes = used_bytes;
+    return current;
+}
+
+static void heap_free(Block *block);
+
+// Carves a block whose payload is a multiple of `align` (a power of two
+// above ALIGNMENT). We take a block with enough slack to leave room for a
+// whole free block in front of the aligned payload, then give the lead and
+// any tail back, so the result is an ordinary block r_free understands.
+static Block* heap_alloc_aligned(int zone, size_t size, size_t align) {
+    size_t lead_min = (sizeof(Block) + MIN_PAYLOAD + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    size_t used_before = used_bytes;
+    size_t peak_before = peak_used_bytes;
+    Block *block = heap_alloc(zone, size + align + lead_min);
+    if (!block) return NULL;
+
+    char *payload = (char*)block + sizeof(Block);
+    if ((uintptr_t)payload & (align - 1)) {
+        char *aligned = (char*)(((uintptr_t)payload + lead_min + align - 1) & ~(uintptr_t)(align - 1));
+        Block *lead = block;
+        block = (Block*)(aligned - sizeof(Block));
+        block->size = (char*)next_block(lead) - aligned;
+        block->free = 0;
+        block->sampled = 0;
+        block->zone = lead->zone;
+        lead->size = (char*)block - payload;
+        heap_free(lead); // sets block->prev_free
+    }
+
+    if (block->size >= size + sizeof(Block) + MIN_PAYLOAD) {
+        Block *tail = (Block*)((char*)block + sizeof(Block) + size);
+        tail->size = block->size - size - sizeof(Block);
+        tail->free = 0;
+        tail->sampled = 0;
+        tail->prev_free = 0;
+        tail->zone = block->zone;
+        block->size = size;
+        heap_free(tail);
+    }
+
+    // The lead and tail headers were never payload: count just the result
+    used_bytes = used_before + block->size;
+    peak_used_bytes = used_bytes > peak_before ? used_bytes : peak_before;
+    return block;
+}
+
+static void heap_free(Block *block) {
+    block->free = 1;
+    used_bytes -= block->size;
+
+    // Coalesce with the following block
+    Block *next = next_block(block);
+    if (next->free == BLOCK_FREE) {
+        if (trim_cursor == next) trim_cursor = block;
+        bin_remove(next);
+        block->size += sizeof(Block) + next->size;
+    }
+
+    // Coalesce with the preceding block (found through its footer)
+    if (block->prev_free) {
+        Block *prev = prev_block(block);
+        if (trim_cursor == block) trim_cursor = prev;
+        bin_remove(prev);
+        prev->size += sizeof(Block) + block->size;
+        block = prev;
+    }
+
+    write_footer(block);
+    next_block(block)->prev_free = 1;
+    if (release_segment_if_empty(block, 0)) return;
+    bin_insert(block);
+}
+
+// `align` is ALIGNMENT or a power of two up to MAX_ALIGN. The mapping is
+// page aligned, so the payload only has to sit at a multiple of it.
+static Block* large_alloc(size_t size, size_t align) {
+    size_t header = sizeof(LargeHeader) + sizeof(Block);
+    if (header < align) header = align;
+    size_t bytes = page_round(header + size);
+
+    std::lock_guard<std::mutex> guard(heap_lock);
+    if (!within_cap(bytes)) return NULL;
+    char *base = (char*)map_pages(bytes);
+    if (!base) return NULL;
+    mapped_bytes += bytes;
+    large_count++;
+    large_bytes += bytes;
+
+    Block *block = (Block*)(base + header - sizeof(Block));
+    LargeHeader *large = (LargeHeader*)block - 1;
+    large->base = base;
+    large->mapped = bytes;
+    block->size = size;
+    block->free = 0;
+    block->sampled = 0;
+    block->prev_free = 0;
+    block->zone = ZONE_LARGE;
+    used_bytes += size;
+    if (used_bytes > peak_used_bytes) peak_used_bytes = used_bytes;
+    return block;
+}
+
+static void large_free(Block *block) {
+    LargeHeader *large = (LargeHeader*)block - 1;
+    std::lock_guard<std::mutex> guard(heap_lock);
+    used_bytes -= block->size;
+    mapped_bytes -= large->mapped;
+    large_count--;
+    large_bytes -= large->mapped;
+    munmap(large->base, large->mapped);
+}
+
+static inline int is_large(size_t size) {
+    size_t threshold = __atomic_load_n(&large_threshold, __ATOMIC_RELAXED);
+    return threshold && size >= threshold;
+}
+
+// --- THREAD CACHE ---
+// Small blocks are cached per thread, so the common r_alloc/r_free path
+// never touches heap_lock. Cached blocks are BLOCK_TCACHED: the backend
+// treats them as used (no coalescing into them), r_free as already free.
+// Empty lists are refilled, and over-full ones flushed, TCACHE_BATCH
+// blocks at a time under a single lock acquisition.
+ThreadCache::~ThreadCache() {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    for (int zone = 0; zone < ZONE_COUNT; zone++) {
+        for (int i = 0; i < TCACHE_CLASSES; i++) {
+            while (lists[zone][i]) {
+                Block *block = lists[zone][i];
+                lists[zone][i] = links(block)->next;
+                heap_free(block);
             }
+            counts[zone][i] = 0;
+        }
+    }
+}
+
+static thread_local ThreadCache tcache;
 
-            return ptr;
+static Block* tcache_pop(int zone, size_t size) {
+    int index = (int)(size / ALIGNMENT);
+    Block **list = &tcache.lists[zone][index];
+    Block *block = *list;
+    if (!block) {
+        std::lock_guard<std::mutex> guard(heap_lock);
+        for (int i = 0; i < TCACHE_BATCH; i++) {
+            Block *fresh = heap_alloc(zone, size);
+            if (!fresh) break;
+            fresh->free = BLOCK_TCACHED;
+            links(fresh)->next = *list;
+            *list = fresh;
+            tcache.counts[zone][index]++;
         }
-        current = current->next;
+        block = *list;
+        if (!block) return NULL;
+    }
+    *list = links(block)->next;
+    tcache.counts[zone][index]--;
+    block->free = BLOCK_USED;
+    return block;
+}
+
+static void tcache_push(Block *block) {
+    int zone = block->zone;
+    int index = (int)(block->size / ALIGNMENT);
+    Block **list = &tcache.lists[zone][index];
+    block->free = BLOCK_TCACHED;
+    links(block)->next = *list;
+    *list = block;
+    if (++tcache.counts[zone][index] <= TCACHE_LIMIT) return;
+
+    std::lock_guard<std::mutex> guard(heap_lock);
+    for (int i = 0; i < TCACHE_BATCH; i++) {
+        Block *old = *list;
+        *list = links(old)->next;
+        heap_free(old);
+    }
+    tcache.counts[zone][index] -= TCACHE_BATCH;
+}
+
+static inline const SitePolicy* site_policy(uint32_t site_id) {
+    PolicyTable *table = __atomic_load_n(&policy, __ATOMIC_ACQUIRE);
+    if (!table || site_id == 0) return NULL;
+    size_t i = (site_id * 2654435761u) & table->mask;
+    while (table->slots[i].site_id) {
+        if (table->slots[i].site_id == site_id) return &table->slots[i];
+        i = (i + 1) & table->mask;
     }
     return NULL;
 }
 
+// Reads a policy file (site_id,lifetime,size_class per line, lifetime
+// numbered like lifetime_t) and swaps it in. Returns the number of sites
+// loaded, 0 if the file could not be read.
+size_t r_load_policy(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return 0;
+
+    size_t count = 0;
+    size_t capacity = 64;
+    unsigned int *rows = (unsigned int*)malloc(capacity * 3 * sizeof(unsigned int));
+    char line[128];
+    while (rows && fgets(line, sizeof(line), file)) {
+        unsigned int site_id, lifetime, size_class;
+        if (sscanf(line, "%u,%u,%u", &site_id, &lifetime, &size_class) != 3) continue; // header
+        if (site_id == 0 || lifetime > 2) continue;
+        if (count == capacity) {
+            capacity *= 2;
+            unsigned int *grown = (unsigned int*)realloc(rows, capacity * 3 * sizeof(unsigned int));
+            if (!grown) break;
+            rows = grown;
+        }
+        rows[count * 3] = site_id;
+        rows[count * 3 + 1] = lifetime;
+        rows[count * 3 + 2] = size_class;
+        count++;
+    }
+    fclose(file);
+    if (!rows || count == 0) {
+        free(rows);
+        return 0;
+    }
+
+    // Keep the table at most half full so probes stay short
+    size_t slots = 16;
+    while (slots < count * 2) slots *= 2;
+    PolicyTable *table = (PolicyTable*)malloc(sizeof(PolicyTable));
+    SitePolicy *entries = (SitePolicy*)calloc(slots, sizeof(SitePolicy));
+    if (!table || !entries) {
+        free(table);
+        free(entries);
+        free(rows);
+        return 0;
+    }
+    table->mask = slots - 1;
+    table->slots = entries;
+
+    // lifetime_t: 0 TRANSIENT, 1 INTERMEDIATE, 2 PERSISTENT
+    static const uint32_t zone_of_lifetime[3] = { ZONE_TRANSIENT, ZONE_INTERMEDIATE, ZONE_DEFAULT };
+    for (size_t r = 0; r < count; r++) {
+        size_t i = (rows[r * 3] * 2654435761u) & table->mask;
+        while (entries[i].site_id && entries[i].site_id != rows[r * 3]) i = (i + 1) & table->mask;
+        entries[i].site_id = rows[r * 3];
+        entries[i].zone = zone_of_lifetime[rows[r * 3 + 1]];
+        entries[i].size_class = ((size_t)rows[r * 3 + 2] + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    }
+    free(rows);
+
+    __atomic_store_n(&policy, table, __ATOMIC_RELEASE);
+    return count;
+}
+
+// Routes trained sites to the zone of their predicted lifetime and turns
+// `*size` into a block payload size. -1 if `*size` is too big to serve.
+static inline int route(uint32_t site_id, size_t *size) {
+    if (*size > MAX_REQUEST_SIZE) return -1;
+    int zone = ZONE_DEFAULT;
+    const SitePolicy *site = site_policy(site_id);
+    if (site) {
+        zone = site->zone;
+        if (*size <= site->size_class) *size = site->size_class;
+    }
+    if (*size < MIN_PAYLOAD) *size = MIN_PAYLOAD;
+    *size = (*size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    return zone;
+}
+
+void* r_alloc(size_t size, uint32_t site_id) {
+    int zone = route(site_id, &size);
+    if (zone < 0) return NULL;
+
+    Block *current;
+    if (size <= TCACHE_MAX_SIZE) {
+        current = tcache_pop(zone, size);
+    } else if (is_large(size)) {
+        current = large_alloc(size, ALIGNMENT);
+    } else {
+        std::lock_guard<std::mutex> guard(heap_lock);
+        current = heap_alloc(zone, size);
+    }
+    if (!current) return NULL;
+
+    void* ptr = (void*)((char*)current + sizeof(Block));
+
+    // --- PROFILING: Record Birth ---
+    if (PROFILING_MODE) {
+        current->sampled = should_sample() && sample_insert(ptr, site_id, size);
+    }
+
+    return ptr;
+}
+
+// `align` must be a power of two up to MAX_ALIGN (NULL otherwise). Aligned
+// blocks skip the thread cache on the way in, but are freed like any other.
+void* r_alloc_aligned(size_t size, size_t align, uint32_t site_id) {
+    if (align == 0 || (align & (align - 1)) || align > MAX_ALIGN) return NULL;
+    if (align <= ALIGNMENT) return r_alloc(size, site_id);
+
+    int zone = route(site_id, &size);
+    if (zone < 0) return NULL;
+    Block *current;
+    if (is_large(size)) {
+        current = large_alloc(size, align);
+    } else {
+        std::lock_guard<std::mutex> guard(heap_lock);
+        current = heap_alloc_aligned(zone, size, align);
+    }
+    if (!current) return NULL;
+
+    void* ptr = (void*)((char*)current + sizeof(Block));
+    if (PROFILING_MODE) {
+        current->sampled = should_sample() && sample_insert(ptr, site_id, size);
+    }
+    return ptr;
+}
+
 void r_free(void* ptr) {
     if (!ptr) return;
 
+    Block *block = (Block*)((char*)ptr - sizeof(Block));
+    if (block->free != BLOCK_USED) return; // double free: binned or in a thread cache
+
     // --- PROFILING: Record Death ---
-    if (PROFILING_MODE) {
-        if (shadow_map.count(ptr)) {
-            AllocationMeta meta = shadow_map[ptr];
-            uint64_t lifespan = get_nanos() - meta.start_time;
-            
-            // Log to CSV: site_id, size, lifespan
-            if (log_file) {
-                fprintf(log_file, "%u,%lu,%lu\n", meta.site_id, meta.size, lifespan);
-                // Flush occasionally to ensure data is written if we crash
-                // fflush(log_file); 
+    if (PROFILING_MODE && block->sampled) {
+        block->sampled = 0;
+        sample_remove(ptr);
+    }
+
+    if (block->zone == ZONE_LARGE) {
+        large_free(block);
+        return;
+    }
+    if (block->size <= TCACHE_MAX_SIZE) {
+        tcache_push(block);
+        return;
+    }
+    std::lock_guard<std::mutex> guard(heap_lock);
+    heap_free(block);
+}
+
+size_t r_block_size(void* ptr) {
+    if (!ptr) return 0;
+    Block *block = (Block*)((char*)ptr - sizeof(Block));
+    return block->free == BLOCK_USED ? block->size : 0;
+}
+
+// Incremental trim: visits at most `budget` blocks (0 = whole heap) and
+// resumes where the previous call stopped. It moves nothing, so it leaves
+// r_fragmentation as it was: heap_free coalesces on every call, so two
+// free blocks are never neighbours, and live blocks stay put. What this
+// pass does is give memory back: a wholly free segment
+// that heap_free kept as its zone's last one is unmapped once the zone has
+// grown another, and the whole pages inside the other free blocks are
+// madvise'd away so a fragmented heap does not keep its peak RSS.
+// Returns the bytes handed back (pages of a block released on an earlier
+// pass count again).
+size_t r_trim(size_t budget) {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    if (!segments) return 0;
+    if (budget == 0) trim_cursor = segments->first;
+
+    size_t released = 0;
+    size_t visited = 0;
+    // Releasing part of a huge page would split it (THP) or fail (hugetlb)
+    size_t page = huge_pages ? HUGE_PAGE_SIZE : PAGE_SIZE;
+    while (budget == 0 || visited < budget) {
+        if (!trim_cursor) trim_cursor = segments->first;
+        Block *block = trim_cursor;
+        if (block->size == 0) { // epilogue, move on to the next segment
+            Segment *seg = segment_of(block);
+            trim_cursor = seg->next ? seg->next->first : segments->first;
+            if (budget == 0 && !seg->next) break;
+            continue;
+        }
+        visited++;
+
+        if (block->free == BLOCK_FREE) {
+            Block *next = next_block(block);
+            if (next->size == 0) { // the segment may be wholly free
+                size_t seg_size = segment_of(next)->size;
+                if (release_segment_if_empty(block, 1)) {
+                    released += seg_size;
+                    continue;
+                }
+            }
+
+            // Release whole pages between the free links and the footer
+            char *lo = (char*)block + sizeof(Block) + sizeof(FreeLinks);
+            char *hi = (char*)next - sizeof(size_t);
+            char *page_lo = (char*)(((uintptr_t)lo + page - 1) & ~(uintptr_t)(page - 1));
+            char *page_hi = (char*)((uintptr_t)hi & ~(uintptr_t)(page - 1));
+            if (page_hi > page_lo) {
+                madvise(page_lo, page_hi - page_lo, MADV_DONTNEED);
+                released += page_hi - page_lo;
             }
-            shadow_map.erase(ptr);
         }
+        trim_cursor = next_block(block);
     }
+    return released;
+}
 
-    Block *block = (Block*)((char*)ptr - sizeof(Block));
-    block->free = 1;
-    // (Coalescing logic omitted for brevity, keep your existing logic here)
-}
\ No newline at end of file
+// Largest binned block of a zone: only the highest non-empty bin is walked.
+// Caller holds heap_lock.
+static size_t zone_largest_free(Zone *z) {
+    size_t largest = 0;
+    for (int word = BITMAP_WORDS - 1; word >= 0 && largest == 0; word--) {
+        if (!z->bin_bitmap[word]) continue;
+        int index = word * 64 + 63 - __builtin_clzll(z->bin_bitmap[word]);
+        for (Block *b = z->bins[index]; b; b = links(b)->next) {
+            if (b->size > largest) largest = b->size;
+        }
+    }
+    return largest;
+}
+
+// 1 - largest_free / total_free: 0 means all free memory is one block,
+// values close to 1 mean free memory is scattered in small pieces.
+// Zones never lend memory to each other, so each contributes its own
+// largest block.
+double r_fragmentation() {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    size_t total = 0;
+    size_t largest = 0;
+    for (int zone = 0; zone < ZONE_COUNT; zone++) {
+        total += zones[zone].free_bytes;
+        largest += zone_largest_free(&zones[zone]);
+    }
+    if (total == 0) return 0.0;
+    return 1.0 - (double)largest / (double)total;
+}
+
+// Snapshot of the heap counters. Everything is maintained on the backend
+// path already, so this only walks the top bin of each zone.
+void r_stats(heap_stats_t *stats) {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    stats->mapped_bytes = mapped_bytes;
+    stats->max_bytes = heap_max_size;
+    stats->segment_count = segment_count;
+    stats->huge_pages = huge_pages;
+    stats->used_bytes = used_bytes;
+    stats->peak_used_bytes = peak_used_bytes;
+    stats->free_bytes = 0;
+    stats->free_blocks = 0;
+    stats->largest_free_block = 0;
+    for (int zone = 0; zone < ZONE_COUNT; zone++) {
+        Zone *z = &zones[zone];
+        size_t largest = zone_largest_free(z);
+        stats->free_bytes += z->free_bytes;
+        stats->free_blocks += z->free_blocks;
+        if (largest > stats->largest_free_block) stats->largest_free_block = largest;
+    }
+    stats->large_objects = large_count;
+    stats->large_bytes = large_bytes;
+}
+
+// Drains the ring, writes a record for every sampled block that is still
+// alive (live = 1, with its age so far as the lifespan) and flushes the
+// file. Without these records the trainer would never see the sites that
+// are never freed. Live blocks may be freed while we walk the table, so
+// this is a snapshot, not an exact census.
+void flush_profiling_data() {
+    if (!PROFILING_MODE || !sample_table) return;
+    std::lock_guard<std::mutex> guard(profile_lock);
+    ring_drain();
+
+    uint64_t now = get_ticks();
+    double tick_rate = ticks_per_ns();
+    for (size_t i = 0; i < SAMPLE_TABLE_SIZE; i++) {
+        AllocationMeta *slot = &sample_table[i];
+        if (__atomic_load_n(&slot->ptr, __ATOMIC_ACQUIRE) <= SAMPLE_BUSY) continue;
+        ProfileRecord record;
+        record.site_id = slot->site_id;
+        record.live = 1;
+        record.size = slot->size;
+        record.lifespan_ns = now - slot->start_ticks;
+        write_record(&record, tick_rate);
+    }
+    if (log_file) fflush(log_file);
+}
+
+void r_set_sample_rate(uint32_t rate) {
+    __atomic_store_n(&sample_rate, rate, __ATOMIC_RELAXED);
+}
+
+// Regions outside the heap segments (large arena chunks in huge page
+// mode). They share the heap cap and mapped_bytes with the segments.
+void* r_map_region(size_t size, size_t *mapped) {
+    if (size > MAX_REQUEST_SIZE) return NULL;
+    size = page_round(size);
+    std::lock_guard<std::mutex> guard(heap_lock);
+    if (!within_cap(size)) return NULL;
+    void *base = map_pages(size);
+    if (!base) return NULL;
+    mapped_bytes += size;
+    *mapped = size;
+    return base;
+}
+
+void r_unmap_region(void *ptr, size_t mapped) {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    mapped_bytes -= mapped;
+    munmap(ptr, mapped);
+}
+
+void r_set_huge_pages(int mode) {
+    std::lock_guard<std::mutex> guard(heap_lock);
+    if (segments) return; // the backing of mapped segments cannot change
+    huge_pages = mode;
+}
+
+int r_huge_pages() {
+    return huge_pages;
+}
+
+void r_set_large_threshold(size_t bytes) {
+    if (bytes && bytes < PAGE_SIZE) bytes = PAGE_SIZE;
+    __atomic_store_n(&large_threshold, bytes, __ATOMIC_RELAXED);
+}
+
+size_t r_large_threshold() {
+    return __atomic_load_n(&large_threshold, __ATOMIC_RELAXED);
+}
@@ -7,12 +7,74 @@
 
 // 1 training mode
 // 0 for prod mode
+#ifndef PROFILING_MODE
 #define PROFILING_MODE 1 
+#endif
 
 void init_heap();
-void* r_alloc(size_t size, uint32_t site_id);
+// `segment_size` must be at least a page. `max_size` 0 keeps the default
+// cap (1GB), smaller caps are raised to one segment. Returns 0 for a
+// sub-page segment size or if the first segment cannot be mapped (the
+// heap stays uninitialized then), 1 once the heap is ready.
+int init_heap_config(size_t segment_size, size_t max_size);
+
+// Huge page backing for heap segments. Pick it before init_heap (or set
+// R_ALLOC_HUGE_PAGES=thp|hugetlb); calls after the heap exists are ignored.
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define HUGE_PAGES_OFF 0
+#define HUGE_PAGES_THP 1      // 2MB-aligned segments + MADV_HUGEPAGE
+#define HUGE_PAGES_HUGETLB 2  // MAP_HUGETLB, THP when no pages are reserved
+void r_set_huge_pages(int mode);
+int r_huge_pages();
+
+// A region mapped on its own with the heap's page backing (counted against
+// the heap cap). `mapped` receives the bytes to pass to r_unmap_region.
+void* r_map_region(size_t size, size_t* mapped);
+void r_unmap_region(void* ptr, size_t mapped);
+
+// Requests of at least this many bytes get a mapping of their own, which
+// r_free unmaps, so they never split a heap segment. 0 turns it off;
+// non-zero values below a page are raised to one. Default 1MB, or
+// R_ALLOC_LARGE_THRESHOLD=<bytes>.
+#define LARGE_THRESHOLD (1024 * 1024)
+void r_set_large_threshold(size_t bytes);
+size_t r_large_threshold();
+
+void* r_alloc(size_t size, uint32_t site_id);             // 16-byte aligned
+void* r_alloc_aligned(size_t size, size_t align, uint32_t site_id); // align: power of two <= 4096
 void r_free(void* ptr);
+// Payload bytes of the live block at `ptr` (at least what was asked for),
+// 0 if it is free (binned or in a thread cache). Like r_free, it trusts
+// `ptr` to be one of ours.
+size_t r_block_size(void* ptr);
+// Hands free pages and empty segments back to the OS, returns the bytes
+// released. Visits at most `budget` blocks (0 = whole heap). Nothing is
+// moved, so fragmentation is unchanged; only RSS goes down.
+size_t r_trim(size_t budget);
+double r_fragmentation();
+size_t r_load_policy(const char* path);
+
+// Heap counters (payload bytes; block headers are not counted)
+typedef struct heap_stats_t {
+    size_t mapped_bytes;       // all segments, from the OS
+    size_t max_bytes;          // cap on mapped_bytes (init_heap_config)
+    size_t segment_count;
+    int huge_pages;            // HUGE_PAGES_* mode
+    size_t used_bytes;         // handed out, including thread-cached blocks
+    size_t peak_used_bytes;    // high-water mark of used_bytes
+    size_t free_bytes;         // sitting in the bins
+    size_t free_blocks;
+    size_t largest_free_block; // biggest request served without a new segment
+    size_t large_objects;      // live dedicated mappings
+    size_t large_bytes;        // bytes mapped for them (part of mapped_bytes)
+} heap_stats_t;
+
+void r_stats(heap_stats_t* stats);
 
 void flush_profiling_data();
+// 1 = every allocation, N = about 1 in N, 0 = off. Sampled blocks go through
+// a shared table and ring, so dense rates are for training runs only.
+#define SAMPLE_RATE_DEFAULT 4096
+void r_set_sample_rate(uint32_t rate);
 
 #endif
\ No newline at end of file
@@ -2,38 +2,325 @@
 #include "allocator.h"
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <mutex>
+
+#define SLAB_RELEASE_OFFSET 4096 // pooled runs keep the page with their header
+#define RUN_CHUNK_LEAD 4096      // page before a run chunk's data, holding its header
+
+// Size class tables, built at compile time: class sizes, and the class of
+// every request size in 16-byte steps, so a lookup is a single load. Each
+// class also gets its run layout (the bitmap takes room from the slots)
+// and a reciprocal that turns a slot offset into its index without a
+// divide: offset * recip >> 32 is exact for every offset inside a run.
+struct slab_classes_t {
+    uint16_t size[SLAB_CLASS_COUNT];
+    uint16_t first[SLAB_CLASS_COUNT];  // offset of slot 0 in its run
+    uint16_t slots[SLAB_CLASS_COUNT];  // slots per run
+    uint32_t recip[SLAB_CLASS_COUNT];  // 2^32 / size, rounded up
+    uint8_t index[SLAB_MAX_SIZE / 16 + 1]; // by (size + 15) / 16
+
+    constexpr slab_classes_t() : size(), first(), slots(), recip(), index() {
+        for (int i = 0; i < SLAB_CLASS_COUNT; i++) {
+            if (i < 8) {
+                size[i] = (uint16_t)(16 * (i + 1));
+            } else {
+                int shift = 7 + (i - 8) / 4; // 128 << 0, 1, 2 ...
+                size[i] = (uint16_t)((1 << shift) + ((i - 8) % 4 + 1) * (1 << (shift - 2)));
+            }
+
+            // Slots start after the header and bitmaps, aligned like the class
+            int align = size[i] & -size[i];
+            int n = (SLAB_RUN_SIZE - SLAB_RUN_HEADER) / size[i];
+            int offset = 0;
+            for (;; n--) {
+                int header = SLAB_RUN_HEADER + 3 * 8 * ((n + 63) / 64); // three bitmaps
+                offset = (header + align - 1) & -align;
+                if (offset + n * size[i] <= SLAB_RUN_SIZE) break;
+            }
+            first[i] = (uint16_t)offset;
+            slots[i] = (uint16_t)n;
+            recip[i] = (uint32_t)((1ull << 32) / size[i] + 1);
+        }
+        int c = 0;
+        for (int q = 0; q <= SLAB_MAX_SIZE / 16; q++) {
+            while (size[c] < q * 16) c++;
+            index[q] = (uint8_t)c;
+        }
+    }
+};
+
+static constexpr slab_classes_t slab_classes;
+static_assert(slab_classes.size[SLAB_CLASS_COUNT - 1] == SLAB_MAX_SIZE, "last class must be SLAB_MAX_SIZE");
+static_assert(slab_classes.slots[0] <= SLAB_RUN_WORDS * 64, "summary word must cover the bitmap");
 
 // Helper functions
 int get_slab_index(size_t size) {
-    if (size <= 32) return 0;
-    if (size <= 64) return 1;
-    if (size <= 128) return 2;
-    if (size <= 256) return 3;
-    if (size <= 512) return 4;
-    if (size <= 1024) return 5;
-    if (size <= 2048) return 6;
-    if (size <= 4096) return 7;
-    return -1; // Too big for slab
+    if (size > SLAB_MAX_SIZE) return -1; // Too big for slab
+    return slab_classes.index[(size + 15) >> 4];
 }
 
 size_t get_class_size(int index){
-    return 32 << index;
+    return slab_classes.size[index];
+}
+
+// Largest power of two dividing the class size: what every slot of the
+// class is aligned to
+static inline size_t class_align(int index){
+    size_t class_size = get_class_size(index);
+    return class_size & (0 - class_size);
+}
+
+// Cheap per-thread identity: the address of a thread_local
+static thread_local char thread_token;
+static inline uintptr_t current_thread() {
+    return (uintptr_t)&thread_token;
+}
+
+// Slots start at a multiple of class_align() past the header and bitmap,
+// so every slot is aligned to it. For power-of-two classes that is the
+// class size itself.
+static inline size_t first_slot(int index){
+    return slab_classes.first[index];
+}
+
+static inline slab_run_t* run_of(void* ptr){
+    return (slab_run_t*)((uintptr_t)ptr & ~(uintptr_t)(SLAB_RUN_SIZE - 1));
+}
+
+// The three bitmaps are interleaved word by word, so everything about a
+// slot sits in adjacent words: bitmap word w is at run_bits()[BIT_WORDS * w
+// + BITS_FREE / BITS_CACHED / BITS_REMOTE]
+#define BIT_WORDS 3
+#define BITS_FREE 0
+#define BITS_CACHED 1
+#define BITS_REMOTE 2
+
+static inline uint64_t* run_bits(slab_run_t* run){
+    return (uint64_t*)(run + 1);
+}
+
+static inline uint64_t* slot_word(slab_run_t* run, uint32_t slot, int which){
+    return &run_bits(run)[BIT_WORDS * (slot >> 6) + which];
+}
+
+// Run headers and the free / cached words are written by the owner only,
+// but push_remote_free reads them from other threads. The owner reads them
+// plainly and writes them with relaxed atomic stores (plain moves on x86);
+// other threads use atomic loads.
+static inline void set_word(uint64_t* word, uint64_t value){
+    __atomic_store_n(word, value, __ATOMIC_RELAXED);
+}
+
+// Index of the slot at `offset` bytes past the first one. Offsets that are
+// not a whole number of slots come out as the slot they fall inside.
+static inline uint32_t slot_at(int index, size_t offset){
+    return (uint32_t)((offset * slab_classes.recip[index]) >> 32);
+}
+
+static_assert(sizeof(slab_run_t) <= SLAB_RUN_HEADER, "run header must fit before the first slot");
+
+static inline void unlink_partial(arena_t* arena, slab_run_t* run){
+    if (run->prev) run->prev->next = run->next;
+    else arena->slab_cache.partial[run->class_index] = run->next;
+    if (run->next) run->next->prev = run->prev;
+    run->listed = 0;
+}
+
+// Returns the pages of runs that sat in the pool for SLAB_POOL_DECAY
+// allocations, oldest first, keeping the page with the header. Doing it on
+// a delay means a class that empties and refills its runs in quick
+// succession (a batch freed all at once) does not fault them back in every
+// time. In huge page mode this would split a huge page, so they stay.
+static void purge_pool(arena_t* arena){
+    while (arena->pool_tail && arena->slab_ticks - arena->pool_tail->pooled_at > SLAB_POOL_DECAY) {
+        slab_run_t* run = arena->pool_tail;
+        arena->pool_tail = run->prev;
+        if (run->prev) run->prev->next = NULL;
+        else arena->run_pool = NULL;
+
+        if (!r_huge_pages()) {
+            madvise((char*)run + SLAB_RELEASE_OFFSET, SLAB_RUN_SIZE - SLAB_RELEASE_OFFSET, MADV_DONTNEED);
+        }
+        run->released = 1;
+        run->next = arena->released_runs;
+        arena->released_runs = run;
+        arena->released_count++;
+    }
+}
+
+// An empty run leaves its class for the front of the arena's run pool
+static void pool_run(arena_t* arena, slab_run_t* run){
+    int index = run->class_index;
+    arena->slab_cache.runs[index]--;
+    arena->slab_cache.carved[index] -= run->slots;
+    arena->slab_cache.free_count[index] -= run->slots;
+
+    __atomic_store_n(&run->magic, 0, __ATOMIC_RELAXED); // stale pointers into it are refused from now on
+    run->pooled_at = arena->slab_ticks;
+    run->prev = NULL;
+    run->next = arena->run_pool;
+    if (run->next) run->next->prev = run;
+    else arena->pool_tail = run;
+    arena->run_pool = run;
+    arena->pooled_runs++;
+    arena->size -= SLAB_RUN_SIZE;
+    purge_pool(arena);
+}
+
+// Owner only: gives slot `slot` back to its run, or returns 0 if it is free
+// already (which is also how a slot never handed out is refused). A run
+// that was full rejoins the partial list, or takes over from a full current
+// run; one that is now empty goes to the pool, unless its class is
+// allocating from it.
+static inline int push_slot(arena_t* arena, slab_run_t* run, uint32_t slot){
+    int index = run->class_index;
+    uint64_t* word = slot_word(run, slot, BITS_FREE);
+    uint64_t bit = 1ull << (slot & 63);
+    if (*word & bit) return 0;
+    set_word(word, *word | bit);
+    run->summary |= 1ull << (slot >> 6);
+    run->live--;
+    arena->slab_cache.free_count[index]++;
+    if (run == arena->slab_cache.current[index]) return 1;
+
+    if (run->live == 0) {
+        if (run->listed) unlink_partial(arena, run);
+        pool_run(arena, run);
+    } else if (!run->listed) {
+        // Steady churn: the current run is full, so the next request would
+        // come here anyway. Switch now rather than through the list.
+        slab_run_t* current = arena->slab_cache.current[index];
+        if (current && !current->summary) {
+            arena->slab_cache.current[index] = run;
+            return 1;
+        }
+        run->prev = NULL;
+        run->next = arena->slab_cache.partial[index];
+        if (run->next) run->next->prev = run;
+        arena->slab_cache.partial[index] = run;
+        run->listed = 1;
+    }
+    return 1;
+}
+
+// Owner only: take the whole remote stack at once and sort it back into
+// the runs' bitmaps. Taking everything with one exchange (instead of
+// popping nodes) is what keeps the stack free of ABA problems.
+static void drain_remote_frees(arena_t* arena){
+    slab_slot_t* node = __atomic_exchange_n(&arena->remote_free, NULL, __ATOMIC_ACQUIRE);
+    while (node) {
+        slab_slot_t* next = node->next;
+        slab_run_t* run = run_of(node);
+        uint32_t slot = slot_at(run->class_index, (char*)node - ((char*)run + first_slot(run->class_index)));
+        // Free first, then drop the claim: a second remote free in between
+        // must find one of the two bits set
+        push_slot(arena, run, slot);
+        __atomic_fetch_and(slot_word(run, slot, BITS_REMOTE), ~(1ull << (slot & 63)), __ATOMIC_RELEASE);
+        node = next;
+    }
+}
+
+// Non-owner threads: 0 if the slot is not issued. The remote bit is
+// claimed first, which refuses a second free from another thread before
+// the owner drains the first, and (acquire against the drain's release)
+// orders this free after the owner's last use of the slot. The free and
+// cached words belong to the owner, which writes them atomically
+// (set_word), so they can be read here.
+static int push_remote_free(arena_t* arena, slab_run_t* run, uint32_t slot, void* ptr){
+    uint64_t* words = slot_word(run, slot, BITS_FREE);
+    uint64_t bit = 1ull << (slot & 63);
+    if (__atomic_fetch_or(&words[BITS_REMOTE], bit, __ATOMIC_ACQUIRE) & bit) return 0;
+    if ((__atomic_load_n(&words[BITS_FREE], __ATOMIC_RELAXED) |
+         __atomic_load_n(&words[BITS_CACHED], __ATOMIC_RELAXED)) & bit) {
+        __atomic_fetch_and(&words[BITS_REMOTE], ~bit, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    slab_slot_t* node = (slab_slot_t*)ptr;
+    slab_slot_t* head = __atomic_load_n(&arena->remote_free, __ATOMIC_RELAXED);
+    do {
+        node->next = head;
+    } while (!__atomic_compare_exchange_n(&arena->remote_free, &head, node,
+                                          true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return 1;
 }
 
+// Runs are stamped with their arena's magic. Arena memory comes back from
+// the heap with whatever the last user left in it, including the headers
+// of runs from an arena that is gone (or from before a reset), so the
+// magic changes with every generation and those headers stop matching.
+static uint32_t run_generation = 0;
+
 void init_slab_cache(arena_t* arena){
+    uint32_t generation = __atomic_add_fetch(&run_generation, 1, __ATOMIC_RELAXED);
+    uint32_t magic = SLAB_RUN_MAGIC ^ (generation * 0x9e3779b9u);
+    if (!magic) magic = SLAB_RUN_MAGIC; // 0 marks a pooled run
+    __atomic_store_n(&arena->run_magic, magic, __ATOMIC_RELAXED);
+    arena->run_pool = NULL;
+    arena->pool_tail = NULL;
+    arena->released_runs = NULL;
+    arena->pooled_runs = 0;
+    arena->released_count = 0;
+    arena->slab_ticks = 0;
     for (int i = 0 ; i < SLAB_CLASS_COUNT; i++){
-        arena->slab_cache.free_lists[i] = NULL;
+        arena->slab_cache.current[i] = NULL;
+        arena->slab_cache.partial[i] = NULL;
+        arena->slab_cache.recent[i] = NULL;
+        arena->slab_cache.recent_count[i] = 0;
+        arena->slab_cache.runs[i] = 0;
+        arena->slab_cache.carved[i] = 0;
+        arena->slab_cache.free_count[i] = 0;
+        arena->slab_cache.requests[i] = 0;
+        arena->slab_cache.requested_bytes[i] = 0;
+    }
+}
+
+static void* region_alloc(size_t size, size_t* mapped){
+    *mapped = 0;
+    if (r_huge_pages() && size >= HUGE_PAGE_SIZE) {
+        void* region = r_map_region(size, mapped);
+        if (region) return region;
     }
+    return r_alloc(size, 0);
+}
+
+static void region_free(void* region, size_t mapped){
+    if (mapped) r_unmap_region(region, mapped);
+    else r_free(region);
 }
 
 arena_t* create_arena(size_t size, lifetime_t policy){
+    return create_arena_ex(size, policy, 0, 0);
+}
+
+arena_t* create_arena_ex(size_t size, lifetime_t policy, size_t max_size, uint32_t flags){
     arena_t* new_arena = (arena_t*)r_alloc(sizeof(arena_t), 0); 
     if (!new_arena) return NULL; // Safety check
-    new_arena->base = r_alloc(size, 0);
+    new_arena->base = region_alloc(size, &new_arena->base_mapped);
+    if (!new_arena->base) {
+        r_free(new_arena);
+        return NULL;
+    }
     new_arena->current = new_arena->base;
+    new_arena->end = (char*)new_arena->base + size;
     new_arena->size = 0;
+    new_arena->peak = 0;
     new_arena->capacity = size;
+    new_arena->reserved = size;
+    new_arena->max_capacity = max_size;
+    new_arena->chunks = NULL;
+    new_arena->epoch = 0;
+    new_arena->base_epoch = 0;
     new_arena->policy = policy;
+    new_arena->flags = flags;
+    new_arena->owner = current_thread();
+    new_arena->remote_free = NULL;
+    new_arena->large = NULL;
+    new_arena->large_count = 0;
+    new_arena->large_bytes = 0;
+    new_arena->large_lock = 0;
+    new_arena->pool_next = NULL;
 
     if(policy == LIFETIME_INTERMEDIATE){
         init_slab_cache(new_arena);
@@ -42,96 +329,697 @@ arena_t* create_arena(size_t size, lifetime_t policy){
     return new_arena;
 }
 
-void* r_arena(arena_t* arena, size_t size, uint32_t site_id){
+// Makes `chunk` the arena's newest chunk and bumps from its data next
+static void chain_chunk(arena_t* arena, arena_chunk_t* chunk, void* region, size_t capacity, size_t mapped){
+    chunk->capacity = capacity;
+    chunk->mapped = mapped;
+    chunk->region = region;
+    chunk->epoch = arena->epoch;
+    chunk->next = arena->chunks;
+    __atomic_store_n(&arena->chunks, chunk, __ATOMIC_RELEASE); // see arena_contains
+    arena->reserved += capacity;
+    arena->current = (char*)(chunk + 1);
+    arena->end = (char*)arena->current + capacity;
+}
+
+// Chains a new chunk that can hold at least `needed` bytes. Chunks grow
+// geometrically so a busy arena needs only a few of them, but never past
+// max_capacity.
+static int grow_arena(arena_t* arena, size_t needed){
+    size_t last = arena->chunks ? arena->chunks->capacity : arena->capacity;
+    size_t capacity = last * ARENA_GROWTH_FACTOR;
+    if (capacity < needed) capacity = needed;
+
+    if (arena->max_capacity) {
+        if (arena->reserved + needed > arena->max_capacity) return 0;
+        if (arena->reserved + capacity > arena->max_capacity) {
+            capacity = arena->max_capacity - arena->reserved;
+        }
+    }
+
+    size_t mapped;
+    arena_chunk_t* chunk = (arena_chunk_t*)region_alloc(sizeof(arena_chunk_t) + capacity, &mapped);
+    if (!chunk) return 0;
+    chain_chunk(arena, chunk, chunk, capacity, mapped);
+    return 1;
+}
+
+// Chains a chunk for fresh slab runs. Heap blocks are at most page
+// aligned, so lining a run up inside one would pad up to a whole run;
+// instead the chunk is mapped on its own, over-mapped by a run and trimmed
+// so its data starts on a run boundary with the header in the page before.
+// (Huge page mappings cannot be trimmed that finely; they are 2MB-aligned
+// anyway and give up their first run to the header.)
+static int grow_runs(arena_t* arena){
+    size_t last = arena->chunks ? arena->chunks->capacity : arena->capacity;
+    size_t capacity = (last * ARENA_GROWTH_FACTOR + SLAB_RUN_SIZE - 1) & ~(size_t)(SLAB_RUN_SIZE - 1);
+
+    if (arena->max_capacity) {
+        if (arena->reserved + SLAB_RUN_SIZE > arena->max_capacity) return 0;
+        size_t room = (arena->max_capacity - arena->reserved) & ~(size_t)(SLAB_RUN_SIZE - 1);
+        if (capacity > room) capacity = room;
+    }
+
+    size_t mapped;
+    char* region = (char*)r_map_region(capacity + SLAB_RUN_SIZE, &mapped);
+    if (!region) return 0;
+    char* data = (char*)(((uintptr_t)region + sizeof(arena_chunk_t) + SLAB_RUN_SIZE - 1) &
+                         ~(uintptr_t)(SLAB_RUN_SIZE - 1));
+    if (!r_huge_pages()) {
+        char* head = data - RUN_CHUNK_LEAD;
+        char* tail = data + capacity;
+        if (head > region) r_unmap_region(region, head - region);
+        if (region + mapped > tail) r_unmap_region(tail, region + mapped - tail);
+        mapped = tail - head;
+        region = head;
+    }
+    chain_chunk(arena, (arena_chunk_t*)data - 1, region, capacity, mapped);
+    return 1;
+}
+
+// Bump `size` bytes off the current chunk, chaining a new one if needed
+static inline void* bump(arena_t* arena, size_t size){
+    if ((char*)arena->current + size > (char*)arena->end) {
+        if (!grow_arena(arena, size)) return NULL;
+    }
+    void* ptr = arena->current;
+    arena->current = (char*)arena->current + size;
+    arena->size += size;
+    if (arena->size > arena->peak) arena->peak = arena->size;
+    return ptr;
+}
+
+// Like bump(), but the returned address is a multiple of `align` (a power of two)
+static inline void* bump_aligned(arena_t* arena, size_t size, size_t align){
+    char* aligned = (char*)(((uintptr_t)arena->current + align - 1) & ~(uintptr_t)(align - 1));
+    if (aligned + size > (char*)arena->end) {
+        if (!grow_arena(arena, size + align - 1)) return NULL;
+        aligned = (char*)(((uintptr_t)arena->current + align - 1) & ~(uintptr_t)(align - 1));
+    }
+    arena->size += (aligned - (char*)arena->current) + size;
+    arena->current = aligned + size;
+    if (arena->size > arena->peak) arena->peak = arena->size;
+    return aligned;
+}
+
+// Is `addr` inside memory this arena got from the heap? Other threads call
+// this for remote frees: chunks are only ever pushed on the front (with a
+// release store) while the arena is in use, and a chunk's fields never
+// change once it is chained. Chunks are released only by r_reset /
+// r_destroy, which no free may overlap (its pointer dies with them).
+static int arena_contains(arena_t* arena, void* addr){
+    char* p = (char*)addr;
+    if (p >= (char*)arena->base && p < (char*)arena->base + arena->capacity) return 1;
+    for (arena_chunk_t* chunk = __atomic_load_n(&arena->chunks, __ATOMIC_ACQUIRE); chunk; chunk = chunk->next) {
+        char* data = (char*)(chunk + 1);
+        if (p >= data && p < data + chunk->capacity) return 1;
+    }
+    return 0;
+}
+
+// Maps `ptr` to its run and slot index, or NULL if it is not a slot of
+// this arena's runs. Any thread may call it: the header is read with atomic
+// loads, and new_run publishes it with a release store of the magic.
+static slab_run_t* owned_run(arena_t* arena, void* ptr, uint32_t* slot){
+    slab_run_t* run = run_of(ptr);
+    if (!arena_contains(arena, run)) return NULL;
+    if (__atomic_load_n(&run->magic, __ATOMIC_ACQUIRE) != __atomic_load_n(&arena->run_magic, __ATOMIC_RELAXED) ||
+        __atomic_load_n(&run->owner, __ATOMIC_RELAXED) != arena) {
+        return NULL;
+    }
+
+    int index = __atomic_load_n(&run->class_index, __ATOMIC_RELAXED);
+    char* first = (char*)run + first_slot(index);
+    if ((char*)ptr < first) return NULL;
+    size_t offset = (size_t)((char*)ptr - first);
+    *slot = slot_at(index, offset);
+    if (*slot >= __atomic_load_n(&run->slots, __ATOMIC_RELAXED) || *slot * get_class_size(index) != offset) {
+        return NULL;
+    }
+    return run;
+}
+
+// A run for class `index`: the most recently pooled one (its pages are
+// likely still warm), then a released one, and only then fresh memory
+static slab_run_t* new_run(arena_t* arena, int index){
+    slab_run_t* run = arena->run_pool;
+    int resident = run != NULL;
+    if (run) {
+        arena->run_pool = run->next;
+        if (run->next) run->next->prev = NULL;
+        else arena->pool_tail = NULL;
+    } else if ((run = arena->released_runs)) {
+        arena->released_runs = run->next;
+        arena->released_count--;
+    }
+    if (run) {
+        arena->pooled_runs--;
+        arena->size += SLAB_RUN_SIZE;
+        if (arena->size > arena->peak) arena->peak = arena->size;
+    } else {
+        uintptr_t aligned = ((uintptr_t)arena->current + SLAB_RUN_SIZE - 1) & ~(uintptr_t)(SLAB_RUN_SIZE - 1);
+        if (aligned + SLAB_RUN_SIZE > (uintptr_t)arena->end && !grow_runs(arena)) return NULL;
+        run = (slab_run_t*)bump_aligned(arena, SLAB_RUN_SIZE, SLAB_RUN_SIZE);
+    }
+
+    run->next = NULL;
+    run->prev = NULL;
+    arena->slab_cache.runs[index]++;
+    arena->slab_cache.carved[index] += slab_classes.slots[index];
+    arena->slab_cache.free_count[index] += slab_classes.slots[index];
+    // Back in its own class with its pages intact: its bitmap already has
+    // every slot free
+    if (!(resident && run->class_index == index)) {
+        // Only the header and bitmaps are written; the slots are left alone.
+        // (A pooled run has no cached or remote slots: those count as live.)
+        uint32_t slots = slab_classes.slots[index];
+        uint32_t words = (slots + 63) / 64;
+        uint64_t* bits = run_bits(run);
+        for (uint32_t w = 0; w < words; w++) {
+            uint64_t free_bits = w == words - 1 && slots % 64 ? (1ull << (slots % 64)) - 1 : ~0ull;
+            set_word(&bits[BIT_WORDS * w + BITS_FREE], free_bits);
+            set_word(&bits[BIT_WORDS * w + BITS_CACHED], 0);
+            set_word(&bits[BIT_WORDS * w + BITS_REMOTE], 0);
+        }
+        run->summary = words == 64 ? ~0ull : (1ull << words) - 1;
+        __atomic_store_n(&run->class_index, (uint16_t)index, __ATOMIC_RELAXED);
+        __atomic_store_n(&run->owner, arena, __ATOMIC_RELAXED);
+        __atomic_store_n(&run->slots, slots, __ATOMIC_RELAXED);
+        run->live = 0;
+        run->listed = 0;
+        run->released = 0;
+    }
+    // Last, so a thread that sees the magic sees the rest of the header
+    __atomic_store_n(&run->magic, arena->run_magic, __ATOMIC_RELEASE);
+    return run;
+}
+
+// Hands every chained chunk back to the heap, keeping only the first
+static void release_chunks(arena_t* arena){
+    arena_chunk_t* chunk = arena->chunks;
+    while (chunk) {
+        arena_chunk_t* next = chunk->next;
+        region_free(chunk->region, chunk->mapped);
+        chunk = next;
+    }
+    __atomic_store_n(&arena->chunks, NULL, __ATOMIC_RELAXED);
+    arena->base_epoch = ++arena->epoch;
+    arena->reserved = arena->capacity;
+    arena->current = arena->base;
+    arena->end = (char*)arena->base + arena->capacity;
+    arena->size = 0;
+}
+
+// --- LARGE OBJECTS (INTERMEDIATE) ---
+// They come and go through the heap, which already takes a lock (or maps
+// them outright), so a spin flag around the list costs next to nothing and
+// lets non-owner threads free them directly.
+static inline void lock_large(arena_t* arena){
+    while (__atomic_exchange_n(&arena->large_lock, 1, __ATOMIC_ACQUIRE)) {}
+}
+
+static inline void unlock_large(arena_t* arena){
+    __atomic_store_n(&arena->large_lock, 0, __ATOMIC_RELEASE);
+}
+
+static void* large_alloc(arena_t* arena, size_t size, size_t align){
+    // The header sits right before the payload, padded out to `align`
+    size_t header = sizeof(arena_large_t) > align ? sizeof(arena_large_t) : align;
+    if (arena->max_capacity &&
+        arena->reserved + __atomic_load_n(&arena->large_bytes, __ATOMIC_RELAXED) + size > arena->max_capacity) {
+        return NULL;
+    }
+    void* block = r_alloc_aligned(header + size, align, 0);
+    if (!block) return NULL;
+
+    char* ptr = (char*)block + header;
+    arena_large_t* large = (arena_large_t*)ptr - 1;
+    large->block = block;
+    large->size = size;
+    large->prev = NULL;
+
+    lock_large(arena);
+    large->next = arena->large;
+    if (arena->large) arena->large->prev = large;
+    arena->large = large;
+    arena->large_count++;
+    arena->large_bytes += size;
+    unlock_large(arena);
+    return ptr;
+}
+
+// Large objects are few, so the list walk is what tells us `ptr` is one
+// of ours without reading memory in front of a pointer we do not know
+static int large_free(arena_t* arena, void* ptr){
+    lock_large(arena);
+    arena_large_t* large = arena->large;
+    while (large && (void*)(large + 1) != ptr) large = large->next;
+    if (!large) {
+        unlock_large(arena);
+        return 0;
+    }
+    if (large->prev) large->prev->next = large->next;
+    else arena->large = large->next;
+    if (large->next) large->next->prev = large->prev;
+    arena->large_count--;
+    arena->large_bytes -= large->size;
+    unlock_large(arena);
+
+    r_free(large->block);
+    return 1;
+}
+
+static void release_large(arena_t* arena){
+    lock_large(arena);
+    arena_large_t* large = arena->large;
+    arena->large = NULL;
+    arena->large_count = 0;
+    arena->large_bytes = 0;
+    unlock_large(arena);
+
+    while (large) {
+        arena_large_t* next = large->next;
+        r_free(large->block);
+        large = next;
+    }
+}
+
+// `align` is a power of two, at least 8
+static void* arena_alloc(arena_t* arena, size_t size, size_t align){
+    size_t requested = size;
     // Align everything to 8 bytes minimum for safety
     size = (size + 7) & ~7;
 
     // STRATEGY 1: TRANSIENT (Bump Pointer)
     if(arena->policy == LIFETIME_TRANSIENT){
-        if ((char*)arena->current + size <= (char*)arena->base + arena->capacity){
-            void* ptr = arena->current;
-            arena->current = (char*)arena->current + size;
-            arena->size += size;
-            return ptr;
-        }
+        return align == 8 ? bump(arena, size) : bump_aligned(arena, size, align);
     }
     // STRATEGY 2: INTERMEDIATE (Slab Allocator)
     else if (arena->policy == LIFETIME_INTERMEDIATE){ 
+        if (size < align) size = align;
         int index = get_slab_index(size);
         if(index == -1){
-            return NULL;
+            return large_alloc(arena, size, align);
         }
-        
-        slab_slot_t* free_node = arena->slab_cache.free_lists[index];
+        // Power-of-two classes are aligned to their size, so this stops by
+        // the first one >= align at the latest
+        while (class_align(index) < align) index++;
 
-        if(free_node){
-            arena->slab_cache.free_lists[index] = free_node->next;
-            return (void*)free_node;
-        } else {
-            size_t class_size = get_class_size(index);
-            int items_to_carve = 64; 
-            size_t chunk_needed = class_size * items_to_carve;
+        if (__atomic_load_n(&arena->remote_free, __ATOMIC_RELAXED)) {
+            drain_remote_frees(arena);
+        }
+        
+        // Recently freed slots are still in cache: hand them out first.
+        // Their runs still count them as live, so only the cached bit changes.
+        slab_slot_t* cached = arena->slab_cache.recent[index];
+        if (cached) {
+            uint64_t* cached_word = slot_word(run_of(cached), cached->slot, BITS_CACHED);
+            set_word(cached_word, *cached_word & ~(1ull << (cached->slot & 63)));
+            arena->slab_cache.recent[index] = cached->next;
+            arena->slab_cache.recent_count[index]--;
+            arena->slab_cache.free_count[index]--;
+            arena->slab_ticks++;
+            arena->slab_cache.requests[index]++;
+            arena->slab_cache.requested_bytes[index] += requested;
+            return (void*)cached;
+        }
 
-            if ((char*)arena->current + chunk_needed > (char*)arena->base + arena->capacity) {
-                 return NULL;
+        // Allocate from the current run; when it is full, switch to a
+        // partial run, then to an empty one
+        slab_run_t* run = arena->slab_cache.current[index];
+        if (!run || !run->summary) {
+            run = arena->slab_cache.partial[index];
+            if (run) {
+                unlink_partial(arena, run);
+            } else {
+                run = new_run(arena, index);
+                if (!run) {
+                     return NULL;
+                }
             }
+            arena->slab_cache.current[index] = run;
+            purge_pool(arena);
+        }
 
-            char* block_start = (char*)arena->current;
-            arena->current = block_start + chunk_needed;
-            arena->size += chunk_needed;
+        // Lowest free slot: the first word with one, then its lowest bit
+        uint32_t w = (uint32_t)__builtin_ctzll(run->summary);
+        uint64_t* bits = &run_bits(run)[BIT_WORDS * w + BITS_FREE];
+        uint32_t slot = w * 64 + (uint32_t)__builtin_ctzll(*bits);
+        set_word(bits, *bits & (*bits - 1));
+        if (!*bits) run->summary &= ~(1ull << w);
 
-            for (int i = 1; i < items_to_carve; i++) {
-                slab_slot_t* node = (slab_slot_t*)(block_start + (i * class_size));
-                node->next = arena->slab_cache.free_lists[index];
-                arena->slab_cache.free_lists[index] = node;
-            }
-            return (void*)block_start;
-        }
+        run->live++;
+        arena->slab_cache.free_count[index]--;
+        arena->slab_ticks++;
+        arena->slab_cache.requests[index]++;
+        arena->slab_cache.requested_bytes[index] += requested;
+        return (char*)run + first_slot(index) + (size_t)slot * get_class_size(index);
     }
     // FALLBACK / PERSISTENT
     else {
-        if ((char*)arena->current + size <= (char*)arena->base + arena->capacity){
-            void* ptr = arena->current;
-            arena->current = (char*)arena->current + size;
-            arena->size += size;
-            return ptr;
-        }
+        return align == 8 ? bump(arena, size) : bump_aligned(arena, size, align);
     }
-    return NULL;
 }
 
-void r_arena_free(arena_t* arena, void* ptr, size_t size) {
-    if (!ptr) return;
+void* r_arena(arena_t* arena, size_t size, uint32_t site_id){
+    return arena_alloc(arena, size, (arena->flags & ARENA_CACHE_ALIGN) ? CACHE_LINE_SIZE : 8);
+}
+
+void* r_arena_aligned(arena_t* arena, size_t size, size_t align, uint32_t site_id){
+    if (align == 0 || (align & (align - 1)) || align > ARENA_MAX_ALIGN) return NULL;
+    if (align < 8) align = 8;
+    if ((arena->flags & ARENA_CACHE_ALIGN) && align < CACHE_LINE_SIZE) align = CACHE_LINE_SIZE;
+    return arena_alloc(arena, size, align);
+}
+
+int r_arena_free(arena_t* arena, void* ptr) {
+    if (!ptr) return 0;
 
     if (arena->policy != LIFETIME_INTERMEDIATE) {
-        return; 
+        return 0; 
     }
 
-    int index = get_slab_index(size);
-    if (index == -1) return;
+    uint32_t slot;
+    slab_run_t* run = owned_run(arena, ptr, &slot);
+    if (!run) return large_free(arena, ptr); // 0 if not one of ours either
 
-    slab_slot_t* node = (slab_slot_t*)ptr;
+    if (__atomic_load_n(&arena->owner, __ATOMIC_RELAXED) != current_thread()) {
+        return push_remote_free(arena, run, slot, ptr);
+    }
 
-    // Push back to list
-    node->next = arena->slab_cache.free_lists[index];
-    arena->slab_cache.free_lists[index] = node;
+    // Only an issued slot can come back: not free in its run, not in a
+    // recent list and not queued by another thread. That refuses double
+    // frees and slots of a carved run nobody was given.
+    uint64_t* words = slot_word(run, slot, BITS_FREE);
+    uint64_t bit = 1ull << (slot & 63);
+    if ((words[BITS_FREE] | words[BITS_CACHED] | __atomic_load_n(&words[BITS_REMOTE], __ATOMIC_RELAXED)) & bit) {
+        return 0;
+    }
+
+    // Keep it in the class's recent list so the next request reuses a warm
+    // slot; once that is full, the slot goes back to its run's bitmap
+    int index = run->class_index;
+    if (arena->slab_cache.recent_count[index] < SLAB_RECENT_LIMIT) {
+        slab_slot_t* node = (slab_slot_t*)ptr;
+        set_word(&words[BITS_CACHED], words[BITS_CACHED] | bit);
+        node->slot = slot;
+        node->next = arena->slab_cache.recent[index];
+        arena->slab_cache.recent[index] = node;
+        arena->slab_cache.recent_count[index]++;
+        arena->slab_cache.free_count[index]++;
+        return 1;
+    }
+    return push_slot(arena, run, slot);
 }
 
+size_t r_arena_extent(arena_t* arena, void* ptr){
+    if (!arena || !ptr) return 0;
+    char* p = (char*)ptr;
+
+    if (arena->policy == LIFETIME_INTERMEDIATE) {
+        uint32_t slot;
+        slab_run_t* run = owned_run(arena, ptr, &slot);
+        if (run) {
+            uint64_t* words = slot_word(run, slot, BITS_FREE);
+            uint64_t bit = 1ull << (slot & 63);
+            if ((__atomic_load_n(&words[BITS_FREE], __ATOMIC_RELAXED) |
+                 __atomic_load_n(&words[BITS_CACHED], __ATOMIC_RELAXED)) & bit) {
+                return 0;
+            }
+            return get_class_size(run->class_index);
+        }
+        size_t size = 0;
+        lock_large(arena);
+        for (arena_large_t* large = arena->large; large; large = large->next) {
+            if ((void*)(large + 1) == ptr) {
+                size = large->size;
+                break;
+            }
+        }
+        unlock_large(arena);
+        return size;
+    }
+
+    // Bump arenas: memory past `current` in the active chunk is not handed out
+    char* start = (char*)arena->base;
+    char* end = start + arena->capacity;
+    if (p < start || p >= end) {
+        arena_chunk_t* chunk = arena->chunks;
+        while (chunk && (p < (char*)(chunk + 1) || p >= (char*)(chunk + 1) + chunk->capacity)) {
+            chunk = chunk->next;
+        }
+        if (!chunk) return 0;
+        end = (char*)(chunk + 1) + chunk->capacity;
+    }
+    if (end == (char*)arena->end) end = (char*)arena->current;
+    return p < end ? (size_t)(end - p) : 0;
+}
+
+// Keeps the first chunk and releases the rest, so one unusually large
+// request does not pin its memory for the arena's whole life
 void r_reset(arena_t* arena){
     if (arena && arena->policy == LIFETIME_TRANSIENT){
-        arena->current = arena->base;
-        arena->size = 0;
+        release_chunks(arena);
     }
     else if (arena && arena->policy == LIFETIME_INTERMEDIATE){
         init_slab_cache(arena);
-        arena->current = arena->base;
-        arena->size = 0;
+        __atomic_store_n(&arena->remote_free, NULL, __ATOMIC_RELEASE);
+        release_large(arena);
+        release_chunks(arena);
     }
 }
 
 void r_destroy(arena_t* arena){
     if(arena){
-        r_free(arena->base);
+        release_large(arena);
+        release_chunks(arena);
+        region_free(arena->base, arena->base_mapped);
         r_free(arena);
     }
-}
\ No newline at end of file
+}
+
+// Checkpoints for bump arenas: everything allocated after the mark is
+// dropped in O(1) (plus one r_free per chunk chained since the mark).
+arena_mark_t r_arena_mark(arena_t* arena){
+    arena_mark_t mark;
+    mark.current = arena->current;
+    mark.size = arena->size;
+    mark.chunk = arena->chunks;
+    mark.epoch = arena->chunks ? arena->chunks->epoch : arena->base_epoch;
+    return mark;
+}
+
+int r_arena_rewind(arena_t* arena, arena_mark_t mark){
+    if (!arena || arena->policy == LIFETIME_INTERMEDIATE) return 0;
+
+    // A mark is stale if we already rewound (or reset) past it: either less
+    // is in use now than at mark time, or its chunk is no longer chained.
+    // Chunk addresses get reused, so the chunk must also carry the mark's
+    // epoch; a reset restamps the first region the same way.
+    if (mark.size > arena->size) return 0;
+    arena_chunk_t* chunk = arena->chunks;
+    while (chunk != mark.chunk) {
+        if (!chunk) return 0;
+        chunk = chunk->next;
+    }
+    if (mark.epoch != (chunk ? chunk->epoch : arena->base_epoch)) return 0;
+
+    while (arena->chunks != mark.chunk) {
+        arena_chunk_t* newer = arena->chunks;
+        arena->chunks = newer->next;
+        arena->reserved -= newer->capacity;
+        region_free(newer->region, newer->mapped);
+        arena->epoch++;
+    }
+
+    if (mark.chunk) {
+        arena->end = (char*)(mark.chunk + 1) + mark.chunk->capacity;
+    } else {
+        arena->end = (char*)arena->base + arena->capacity;
+    }
+    arena->current = mark.current;
+    arena->size = mark.size;
+    return 1;
+}
+
+void r_arena_stats(arena_t* arena, arena_stats_t* stats){
+    memset(stats, 0, sizeof(*stats));
+    if (!arena) return;
+
+    stats->policy = arena->policy;
+    stats->used_bytes = arena->size;
+    stats->peak_used_bytes = arena->peak;
+    stats->capacity = arena->capacity;
+    stats->reserved_bytes = arena->reserved;
+    stats->max_capacity = arena->max_capacity;
+    stats->chunk_count = 1;
+    for (arena_chunk_t* chunk = arena->chunks; chunk; chunk = chunk->next) {
+        stats->chunk_count++;
+    }
+    stats->large_objects = arena->large_count;
+    stats->large_bytes = arena->large_bytes;
+
+    if (arena->policy == LIFETIME_INTERMEDIATE) {
+        size_t served = 0;
+        size_t requested = 0;
+        for (int i = 0; i < SLAB_CLASS_COUNT; i++) {
+            slab_class_stats_t* slab = &stats->slabs[i];
+            slab->class_size = get_class_size(i);
+            slab->runs = arena->slab_cache.runs[i];
+            slab->carved = arena->slab_cache.carved[i];
+            slab->free = arena->slab_cache.free_count[i];
+            slab->allocated = slab->carved - slab->free;
+            slab->requests = arena->slab_cache.requests[i];
+            slab->requested_bytes = arena->slab_cache.requested_bytes[i];
+            served += slab->requests * slab->class_size;
+            requested += slab->requested_bytes;
+        }
+        if (served) stats->internal_fragmentation = 1.0 - (double)requested / (double)served;
+        stats->pooled_runs = arena->pooled_runs;
+        stats->released_runs = arena->released_count;
+    }
+}
+
+// --- ARENA POOL ---
+// One lock for the whole pool: it is held for a few pointer operations,
+// never across r_alloc / r_free (resets and destroys happen outside it).
+static std::mutex pool_lock;
+static arena_t* arena_pool[LIFETIME_PERSISTENT + 1][ARENA_POOL_BUCKETS];
+static size_t pool_count[LIFETIME_PERSISTENT + 1][ARENA_POOL_BUCKETS];
+static size_t pool_limit = ARENA_POOL_LIMIT;
+static size_t pool_hits = 0;
+static size_t pool_misses = 0;
+static size_t pool_dropped = 0;
+
+static inline size_t bucket_size(int bucket){
+    return (size_t)1 << (bucket + ARENA_POOL_MIN_SHIFT);
+}
+
+// Bucket for a first region of at least `size` bytes, -1 if it is not
+// pooled: too big, or a slab arena whose first region cannot hold a run
+// (its runs all live in chunks, which a release hands back anyway)
+static int pool_bucket(lifetime_t policy, size_t size){
+    int bucket = 0;
+    if (size > ((size_t)1 << ARENA_POOL_MIN_SHIFT)) {
+        int shift = 64 - __builtin_clzll(size - 1);
+        if (shift > ARENA_POOL_MAX_SHIFT) return -1;
+        bucket = shift - ARENA_POOL_MIN_SHIFT;
+    }
+    if (policy == LIFETIME_INTERMEDIATE && bucket_size(bucket) < SLAB_RUN_SIZE) return -1;
+    return bucket;
+}
+
+// Parks a reset arena; 0 if its bucket is full
+static int park_arena(arena_t* arena, int bucket){
+    std::lock_guard<std::mutex> guard(pool_lock);
+    if (pool_count[arena->policy][bucket] >= pool_limit) return 0;
+    arena->pool_next = arena_pool[arena->policy][bucket];
+    arena_pool[arena->policy][bucket] = arena;
+    pool_count[arena->policy][bucket]++;
+    return 1;
+}
+
+arena_t* acquire_arena(lifetime_t policy, size_t size){
+    if ((unsigned)policy > LIFETIME_PERSISTENT) return NULL;
+    int bucket = pool_bucket(policy, size);
+    if (bucket < 0) return create_arena(size, policy);
+
+    arena_t* arena;
+    {
+        std::lock_guard<std::mutex> guard(pool_lock);
+        arena = arena_pool[policy][bucket];
+        if (arena) {
+            arena_pool[policy][bucket] = arena->pool_next;
+            pool_count[policy][bucket]--;
+            pool_hits++;
+        } else {
+            pool_misses++;
+        }
+    }
+    if (!arena) return create_arena(bucket_size(bucket), policy);
+
+    arena->pool_next = NULL;
+    __atomic_store_n(&arena->owner, current_thread(), __ATOMIC_RELAXED);
+    return arena;
+}
+
+void release_arena(arena_t* arena){
+    if (!arena) return;
+    int bucket = pool_bucket(arena->policy, arena->capacity);
+    if (bucket < 0 || arena->capacity != bucket_size(bucket) ||
+        (unsigned)arena->policy > LIFETIME_PERSISTENT) {
+        r_destroy(arena);
+        return;
+    }
+
+    // Back to what create_arena hands out: first region only, nothing used
+    if (arena->policy == LIFETIME_PERSISTENT) release_chunks(arena);
+    else r_reset(arena);
+    arena->peak = 0;
+    arena->max_capacity = 0;
+    arena->flags = 0;
+
+    if (!park_arena(arena, bucket)) {
+        {
+            std::lock_guard<std::mutex> guard(pool_lock);
+            pool_dropped++;
+        }
+        r_destroy(arena);
+    }
+}
+
+size_t prewarm_arenas(lifetime_t policy, size_t size, size_t count){
+    if ((unsigned)policy > LIFETIME_PERSISTENT) return 0;
+    int bucket = pool_bucket(policy, size);
+    if (bucket < 0) return 0;
+
+    for (size_t i = 0; i < count; i++) {
+        arena_t* arena = create_arena(bucket_size(bucket), policy);
+        if (!arena) break;
+        if (!park_arena(arena, bucket)) {
+            r_destroy(arena);
+            break;
+        }
+    }
+    std::lock_guard<std::mutex> guard(pool_lock);
+    return pool_count[policy][bucket];
+}
+
+void r_set_arena_pool_limit(size_t limit){
+    arena_t* excess = NULL;
+    {
+        std::lock_guard<std::mutex> guard(pool_lock);
+        pool_limit = limit;
+        for (int policy = 0; policy <= LIFETIME_PERSISTENT; policy++) {
+            for (int bucket = 0; bucket < ARENA_POOL_BUCKETS; bucket++) {
+                while (pool_count[policy][bucket] > limit) {
+                    arena_t* arena = arena_pool[policy][bucket];
+                    arena_pool[policy][bucket] = arena->pool_next;
+                    pool_count[policy][bucket]--;
+                    arena->pool_next = excess;
+                    excess = arena;
+                }
+            }
+        }
+    }
+    while (excess) {
+        arena_t* next = excess->pool_next;
+        r_destroy(excess);
+        excess = next;
+    }
+}
+
+void r_arena_pool_stats(arena_pool_stats_t* stats){
+    memset(stats, 0, sizeof(*stats));
+    std::lock_guard<std::mutex> guard(pool_lock);
+    for (int policy = 0; policy <= LIFETIME_PERSISTENT; policy++) {
+        for (int bucket = 0; bucket < ARENA_POOL_BUCKETS; bucket++) {
+            stats->parked += pool_count[policy][bucket];
+            stats->parked_bytes += pool_count[policy][bucket] * (bucket_size(bucket) + sizeof(arena_t));
+        }
+    }
+    stats->hits = pool_hits;
+    stats->misses = pool_misses;
+    stats->dropped = pool_dropped;
+    stats->limit = pool_limit;
+}
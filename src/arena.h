@@ -10,31 +10,233 @@ typedef enum {
     LIFETIME_PERSISTENT
 } lifetime_t;
 
-#define SLAB_CLASS_COUNT 8
-#define SLAB_MIN_SIZE 32
+// Slab size classes: 16-byte spacing up to 128, then four classes per
+// doubling (160, 192, 224, 256, 320, ...) up to SLAB_MAX_SIZE, so a slot
+// is never more than about 20% bigger than the request it serves.
+#define SLAB_CLASS_COUNT 28
+#define SLAB_MIN_SIZE 16
+#define SLAB_MAX_SIZE 4096
+
+// Slabs are carved out of runs: SLAB_RUN_SIZE bytes, aligned to their own
+// size, holding slots of a single class. Masking any slot address with
+// ~(SLAB_RUN_SIZE - 1) finds the run header, so a free needs no size and
+// can verify the pointer really came from this arena.
+#define SLAB_RUN_SIZE (64 * 1024)
+#define SLAB_RUN_HEADER 64       // then the run's bitmaps; slots start after them (see first_slot)
+#define SLAB_RUN_MAGIC 0x52554e31 // "RUN1", mixed with a per-arena generation
+#define SLAB_RUN_WORDS 64         // bitmap words for the most slots a run can hold (4096)
+#define SLAB_RECENT_LIMIT 16      // frees a class keeps warm before the rest go back to their runs
 
 typedef struct slab_slot_t{
     struct slab_slot_t*  next;
+    uint32_t slot;       // its index in its run, while on a recent list
 } slab_slot_t;
 
+// Every run tracks its slots in a bitmap right after the header (1 = free)
+// plus a summary word with one bit per non-empty bitmap word, so finding
+// the lowest free slot is two ctz instructions. Two more bitmaps of the
+// same size follow it: slots sitting in their class's recent list, and
+// slots another thread has freed that the owner has not drained yet. A
+// slot in none of the three is issued, and only an issued slot can be freed. Slots are handed out in
+// address order and the allocator never writes to a free one, so pages of
+// a run nobody has reached yet stay untouched. A run whose slots have all
+// come back leaves its class for the arena's run pool, where any class can
+// reuse it; runs left there for SLAB_POOL_DECAY allocations hand their
+// pages back to the OS.
+#define SLAB_POOL_DECAY (64 * 1024)
+
+typedef struct slab_run_t {
+    uint32_t magic;
+    uint16_t class_index;
+    uint8_t listed;      // 1 while on the partial list
+    uint8_t released;    // pooled, pages returned to the OS
+    struct arena_t* owner;
+    uint32_t slots;      // slots in the run
+    uint32_t live;       // of those, handed out
+    uint64_t summary;    // bit w set: bits()[w] has a free slot
+    struct slab_run_t* next; // in its class's partial list, or the run pool
+    struct slab_run_t* prev;
+    uint32_t pooled_at;  // arena->slab_ticks when it entered the pool
+} slab_run_t;
+
 typedef struct {
-    slab_slot_t* free_lists[SLAB_CLASS_COUNT];
+    slab_run_t* current[SLAB_CLASS_COUNT]; // run each class allocates from
+    slab_run_t* partial[SLAB_CLASS_COUNT]; // other runs with free slots
+    slab_slot_t* recent[SLAB_CLASS_COUNT];   // latest local frees, handed out first
+    uint32_t recent_count[SLAB_CLASS_COUNT];
+    // Stats, owner thread only
+    size_t runs[SLAB_CLASS_COUNT];
+    size_t carved[SLAB_CLASS_COUNT];      // slots in the class's runs
+    size_t free_count[SLAB_CLASS_COUNT];  // of those, not handed out
+    size_t requests[SLAB_CLASS_COUNT];    // allocations served, since the last reset
+    size_t requested_bytes[SLAB_CLASS_COUNT]; // bytes asked for by those allocations
 } slab_cache_t;
 
+// Extra memory an arena chains on when its current chunk is full.
+// The usable bytes follow the header. In huge page mode, regions of
+// HUGE_PAGE_SIZE or more are mapped on their own (2MB-aligned) instead of
+// being carved out of a heap segment.
+typedef struct arena_chunk_t {
+    struct arena_chunk_t* next; // previously added chunk
+    size_t capacity;            // usable bytes in this chunk
+    size_t mapped;              // bytes mapped with r_map_region (0 = from r_alloc)
+    void* region;               // start of that mapping or block (the chunk itself,
+                                // unless it was placed to align its runs)
+    uint64_t epoch;             // arena epoch when chained (tells a reused address apart)
+} arena_chunk_t;
+
+#define ARENA_GROWTH_FACTOR 2
+
+// INTERMEDIATE requests above SLAB_MAX_SIZE get a heap block of
+// their own (a dedicated mapping above the heap's large threshold), with
+// this header right before the payload. They are linked into the arena,
+// so r_arena_free can check them and r_reset / r_destroy free them all.
+typedef struct arena_large_t {
+    struct arena_large_t* next;
+    struct arena_large_t* prev;
+    void* block;         // what r_alloc returned
+    size_t size;         // payload bytes
+} arena_large_t;
+
+// Arena flags (create_arena_ex)
+#define ARENA_CACHE_ALIGN 1 // every allocation starts on its own cache line,
+                            // so objects used by different threads never share one
+#define CACHE_LINE_SIZE 64
+#define ARENA_MAX_ALIGN 4096
+
+// An arena is owned by the thread that created it: the owner's r_arena /
+// r_arena_free take no locks. Slab frees from any other thread are pushed
+// onto `remote_free` (lock-free MPSC stack) and the owner drains them in
+// one batch on its next r_arena call.
 typedef struct arena_t {
-    void* base;          // start of memory region
+    void* base;          // start of the first memory region
     void* current;       // current bump pointer
-    size_t size;         // current usage (offset)
-    size_t capacity;     // max size
+    void* end;           // end of the chunk `current` points into
+    size_t size;         // current usage (bytes handed out)
+    size_t peak;         // high-water mark of `size`
+    size_t capacity;     // size of the first region
+    size_t base_mapped;  // bytes mapped for the first region (0 = from r_alloc)
+    size_t reserved;     // bytes across all chunks
+    size_t max_capacity; // growth limit for `reserved` (0 = unlimited)
+    arena_chunk_t* chunks; // extra chunks, newest first
+    uint64_t epoch;      // bumped on every reset and chunk release, stamps new chunks
+    uint64_t base_epoch; // epoch of the last reset (stamp of the first region)
     lifetime_t policy;   // the strategy this arena uses
+    uint32_t flags;      // ARENA_* flags
     slab_cache_t slab_cache; //if policy == intermediate
+    slab_run_t* run_pool;     // empty runs, any class can take them (newest first)
+    slab_run_t* pool_tail;    // oldest resident run in the pool
+    slab_run_t* released_runs; // pooled runs whose pages were returned
+    size_t pooled_runs;       // both lists
+    size_t released_count;
+    uint32_t slab_ticks;      // slab allocations, the clock for SLAB_POOL_DECAY
+    uint32_t run_magic;       // SLAB_RUN_MAGIC mixed with a generation, new on every reset
+    uintptr_t owner;     // thread token of the owning thread
+    slab_slot_t* remote_free; // cross-thread frees, touched with __atomic builtins
+    arena_large_t* large;     // oversized INTERMEDIATE allocations
+    size_t large_count;
+    size_t large_bytes;
+    int large_lock;           // spin flag for `large`: any thread may free one
+    struct arena_t* pool_next; // while parked in the arena pool
 } arena_t;
 
+// Saved bump position of a TRANSIENT / PERSISTENT arena
+typedef struct arena_mark_t {
+    void* current;
+    size_t size;
+    arena_chunk_t* chunk; // newest chunk at mark time (NULL = first region)
+    uint64_t epoch;       // stamp of `chunk` (or of the first region)
+} arena_mark_t;
+
 arena_t* create_arena(size_t size, lifetime_t policy);
+arena_t* create_arena_ex(size_t size, lifetime_t policy, size_t max_size, uint32_t flags);
 void* r_arena(arena_t* arena, size_t size, uint32_t site_id);
+// `align`: power of two up to ARENA_MAX_ALIGN. Slab arenas serve it from the
+// first class >= max(size, align) whose slots are aligned to it, so it may
+// cost a bigger slot.
+void* r_arena_aligned(arena_t* arena, size_t size, size_t align, uint32_t site_id);
 void r_reset(arena_t* arena);
 void r_destroy(arena_t* arena);
 
-void r_arena_free(arena_t* arena, void* ptr, size_t size);
+// No size needed: the run header knows the class (large objects are
+// looked up in the arena's list). Returns 0 (and does nothing) for
+// pointers this arena never handed out.
+int r_arena_free(arena_t* arena, void* ptr);
+
+// Bytes from `ptr` to the end of what it may be used for: its slab slot or
+// large object (INTERMEDIATE; `ptr` must be the start of a live one), or
+// the chunk it lies in, up to the bump pointer in the current chunk.
+// 0 if the arena does not own `ptr`.
+size_t r_arena_extent(arena_t* arena, void* ptr);
+
+arena_mark_t r_arena_mark(arena_t* arena);
+int r_arena_rewind(arena_t* arena, arena_mark_t mark);
+
+typedef struct slab_class_stats_t {
+    size_t class_size;
+    size_t runs;        // held by the class (empty runs go back to the pool)
+    size_t carved;      // slots in those runs
+    size_t free;        // of those, not handed out
+    size_t allocated;   // carved - free (remote frees count until drained)
+    size_t requests;    // allocations served since the last reset
+    size_t requested_bytes;
+} slab_class_stats_t;
+
+typedef struct arena_stats_t {
+    lifetime_t policy;
+    size_t used_bytes;      // arena->size
+    size_t peak_used_bytes;
+    size_t capacity;        // first region
+    size_t reserved_bytes;  // all chunks
+    size_t max_capacity;    // 0 = unlimited
+    size_t chunk_count;     // first region included
+    size_t large_objects;   // INTERMEDIATE allocations above the slab classes
+    size_t large_bytes;
+    double internal_fragmentation; // INTERMEDIATE: 1 - requested / slot bytes served
+    size_t pooled_runs;     // INTERMEDIATE: empty runs waiting for a class
+    size_t released_runs;   // the pooled runs whose pages went back to the OS
+    slab_class_stats_t slabs[SLAB_CLASS_COUNT]; // INTERMEDIATE only, zeroed otherwise
+} arena_stats_t;
+
+// Reads counters the owner maintains; call it from the owning thread
+void r_arena_stats(arena_t* arena, arena_stats_t* stats);
+
+// --- ARENA POOL ---
+// Reset arenas parked for reuse, so a per-request scratch arena costs a
+// couple of pointer operations instead of create_arena / r_destroy (two
+// r_alloc scans and two r_frees). Buckets are keyed by policy and by
+// capacity rounded up to a power of two between ARENA_POOL_MIN and
+// ARENA_POOL_MAX; each holds at most the pool limit. Bigger arenas, and
+// INTERMEDIATE ones below SLAB_RUN_SIZE, are created and destroyed as
+// usual. Any thread may use the pool: an arena belongs to the thread that
+// acquired it.
+#define ARENA_POOL_MIN_SHIFT 10   // 1KB
+#define ARENA_POOL_MAX_SHIFT 24   // 16MB
+#define ARENA_POOL_BUCKETS (ARENA_POOL_MAX_SHIFT - ARENA_POOL_MIN_SHIFT + 1)
+#define ARENA_POOL_LIMIT 32       // parked arenas per bucket, by default
+
+// An empty arena with at least `size` bytes in its first region (no growth
+// limit, no flags), parked or new
+arena_t* acquire_arena(lifetime_t policy, size_t size);
+// Resets `arena` and parks it, or destroys it if its bucket is full or
+// its capacity is not a bucket size
+void release_arena(arena_t* arena);
+// Parks up to `count` new arenas in the bucket for (policy, size), within
+// the limit. Returns how many are parked there now.
+size_t prewarm_arenas(lifetime_t policy, size_t size, size_t count);
+// Per-bucket limit; lowering it destroys the arenas over it. 0 = no pooling.
+void r_set_arena_pool_limit(size_t limit);
+
+typedef struct arena_pool_stats_t {
+    size_t parked;          // arenas waiting in the pool
+    size_t parked_bytes;    // their first regions and headers (a parked
+                            // arena has released every other chunk)
+    size_t hits;            // acquire_arena calls served from the pool
+    size_t misses;          // ... that had to create an arena
+    size_t dropped;         // releases destroyed because the bucket was full
+    size_t limit;           // per bucket
+} arena_pool_stats_t;
+
+void r_arena_pool_stats(arena_pool_stats_t* stats);
 
 #endif
\ No newline at end of file
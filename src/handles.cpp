@@ -0,0 +1,102 @@
+#include "handles.h"
+#include <stdlib.h>
+
+#define HANDLE_INITIAL_CAPACITY 1024
+
+handle_table_t* create_handle_table() {
+    handle_table_t* table = (handle_table_t*)malloc(sizeof(handle_table_t));
+    if (!table) return NULL;
+    table->capacity = HANDLE_INITIAL_CAPACITY;
+    table->entries = (handle_entry_t*)calloc(table->capacity, sizeof(handle_entry_t));
+    if (!table->entries) {
+        free(table);
+        return NULL;
+    }
+    table->count = 1; // index 0 is HANDLE_NULL
+    table->free_head = 0;
+    return table;
+}
+
+void destroy_handle_table(handle_table_t* table) {
+    if (!table) return;
+    free(table->entries);
+    free(table);
+}
+
+static inline handle_t make_handle(uint32_t index, uint32_t gen) {
+    return (gen << HANDLE_INDEX_BITS) | index;
+}
+
+handle_t handle_new(handle_table_t* table, void* ptr, handle_kind_t kind, handle_t owner) {
+    if (!table || !ptr) return HANDLE_NULL;
+
+    uint32_t index = table->free_head;
+    if (index) {
+        table->free_head = table->entries[index].next;
+    } else {
+        if (table->count > HANDLE_INDEX_MASK) return HANDLE_NULL; // table full
+        if (table->count == table->capacity) {
+            // On failure the old entries stay valid; only this handle fails
+            handle_entry_t* entries = (handle_entry_t*)realloc(table->entries,
+                                                               table->capacity * 2 * sizeof(handle_entry_t));
+            if (!entries) return HANDLE_NULL;
+            table->entries = entries;
+            table->capacity *= 2;
+        }
+        index = table->count++;
+        table->entries[index].gen = 1;
+    }
+
+    handle_entry_t* entry = &table->entries[index];
+    entry->ptr = ptr;
+    entry->kind = (uint16_t)kind;
+    entry->owner = owner & HANDLE_INDEX_MASK;
+    entry->prev = 0;
+    entry->next = 0;
+
+    // Link into the owner's list so resetting the owner can release us
+    if (entry->owner) {
+        handle_entry_t* arena = &table->entries[entry->owner];
+        entry->next = arena->next;
+        if (arena->next) table->entries[arena->next].prev = index;
+        arena->next = index;
+    }
+    return make_handle(index, entry->gen);
+}
+
+static void release_index(handle_table_t* table, uint32_t index) {
+    handle_entry_t* entry = &table->entries[index];
+    entry->ptr = NULL;
+    entry->kind = HANDLE_FREE;
+    entry->owner = 0;
+    entry->gen = entry->gen == HANDLE_MAX_GEN ? 1 : entry->gen + 1;
+    entry->next = table->free_head;
+    table->free_head = index;
+}
+
+int handle_release(handle_table_t* table, handle_t handle) {
+    if (!handle_get(table, handle)) return 0;
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+    handle_entry_t* entry = &table->entries[index];
+
+    // Unlink from the owner's list (an arena's own entry heads that list)
+    if (entry->owner) {
+        if (entry->prev) table->entries[entry->prev].next = entry->next;
+        else table->entries[entry->owner].next = entry->next;
+        if (entry->next) table->entries[entry->next].prev = entry->prev;
+    }
+    release_index(table, index);
+    return 1;
+}
+
+void handle_release_owned(handle_table_t* table, handle_t owner) {
+    if (!handle_get_kind(table, owner, HANDLE_ARENA)) return;
+    handle_entry_t* arena = &table->entries[owner & HANDLE_INDEX_MASK];
+    uint32_t index = arena->next;
+    while (index) {
+        uint32_t next = table->entries[index].next;
+        release_index(table, index);
+        index = next;
+    }
+    arena->next = 0;
+}
@@ -0,0 +1,77 @@
+#ifndef HANDLES_H
+#define HANDLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Compact handles for the JS boundary. A handle packs a table index and a
+// generation counter into 30 bits, so V8 keeps it as a Smi (no heap
+// object per allocation). Releasing an entry bumps its generation, which
+// makes every outstanding copy of the old handle stale.
+typedef uint32_t handle_t;
+
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_GEN_BITS 10
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_MAX_GEN ((1u << HANDLE_GEN_BITS) - 1)
+#define HANDLE_NULL 0
+
+// What an entry points at, so a handle of one kind is never passed to the
+// call for another (r_free on an arena, r_arena on a heap block ...)
+typedef enum {
+    HANDLE_FREE,         // released entry
+    HANDLE_BLOCK,        // r_alloc block
+    HANDLE_ARENA,        // arena_t
+    HANDLE_SLOT          // allocation inside the arena at `owner`
+} handle_kind_t;
+
+typedef struct handle_entry_t {
+    void* ptr;
+    uint16_t gen;
+    uint16_t kind;       // handle_kind_t
+    uint32_t owner;      // index of the owning arena's entry (0 = none)
+    uint32_t next;       // next entry owned by `owner`, or next free entry
+    uint32_t prev;       // previous entry owned by `owner`
+} handle_entry_t;
+
+typedef struct handle_table_t {
+    handle_entry_t* entries;
+    uint32_t count;      // entries in use or on the free list (index 0 reserved)
+    uint32_t capacity;
+    uint32_t free_head;  // first released entry (0 = none)
+} handle_table_t;
+
+// NULL if out of memory
+handle_table_t* create_handle_table();
+void destroy_handle_table(handle_table_t* table);
+
+// owner: handle of the arena the memory belongs to (HANDLE_NULL for none).
+// HANDLE_NULL if the table is full or cannot grow.
+handle_t handle_new(handle_table_t* table, void* ptr, handle_kind_t kind, handle_t owner);
+int handle_release(handle_table_t* table, handle_t handle);
+void handle_release_owned(handle_table_t* table, handle_t owner);
+
+// Resolves a handle of any kind, NULL if it is stale or out of range
+static inline void* handle_get(handle_table_t* table, handle_t handle) {
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+    if (!table || index == 0 || index >= table->count) return NULL;
+    handle_entry_t* entry = &table->entries[index];
+    if (entry->gen != (handle >> HANDLE_INDEX_BITS)) return NULL;
+    return entry->ptr;
+}
+
+// Same, but NULL unless the handle is of `kind`
+static inline void* handle_get_kind(handle_table_t* table, handle_t handle, handle_kind_t kind) {
+    void* ptr = handle_get(table, handle);
+    if (!ptr || table->entries[handle & HANDLE_INDEX_MASK].kind != kind) return NULL;
+    return ptr;
+}
+
+// A HANDLE_SLOT handle's pointer, NULL unless it belongs to `arena`
+static inline void* handle_get_slot(handle_table_t* table, handle_t handle, handle_t arena) {
+    void* ptr = handle_get_kind(table, handle, HANDLE_SLOT);
+    if (!ptr || table->entries[handle & HANDLE_INDEX_MASK].owner != (arena & HANDLE_INDEX_MASK)) return NULL;
+    return ptr;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "hashtable.h"
+#include <string.h>
+
+// Finalizer of MurmurHash3: sequential ids land in unrelated slots
+static inline uint64_t hash_key(uint64_t key){
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+static hash_slot_t* alloc_slots(arena_t* arena, uint32_t capacity){
+    hash_slot_t* slots = (hash_slot_t*)r_arena_aligned(arena, (size_t)capacity * sizeof(hash_slot_t),
+                                                       CACHE_LINE_SIZE, 0);
+    if (slots) memset(slots, 0xff, (size_t)capacity * sizeof(hash_slot_t)); // every key HASH_EMPTY_KEY
+    return slots;
+}
+
+// Slot holding `key`, or -1
+static inline int64_t find_slot(const hash_slot_t* slots, uint32_t mask, uint64_t key){
+    for (uint32_t i = (uint32_t)hash_key(key) & mask;; i = (i + 1) & mask) {
+        if (slots[i].key == key) return i;
+        if (slots[i].key == HASH_EMPTY_KEY) return -1;
+    }
+}
+
+// `key` must not be present
+static inline void place_slot(hash_slot_t* slots, uint32_t mask, uint64_t key, uint64_t value){
+    uint32_t i = (uint32_t)hash_key(key) & mask;
+    while (slots[i].key != HASH_EMPTY_KEY) i = (i + 1) & mask;
+    slots[i].key = key;
+    slots[i].value = value;
+}
+
+// Empties slot `i` and moves back every later entry of its probe run that
+// may sit there, so lookups never need a tombstone to keep probing
+static void clear_slot(hash_slot_t* slots, uint32_t mask, uint32_t i){
+    for (uint32_t j = i;;) {
+        j = (j + 1) & mask;
+        if (slots[j].key == HASH_EMPTY_KEY) break;
+        uint32_t home = (uint32_t)hash_key(slots[j].key) & mask;
+        // The entry stays if its home lies cyclically in (i, j]
+        int stays = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i].key = HASH_EMPTY_KEY;
+}
+
+static void finish_grow(hash_table_t* table){
+    r_arena_free(table->arena, table->old_slots);
+    table->old_slots = NULL;
+    table->old_mask = 0;
+}
+
+// Moves at least `budget` old slots, then up to the end of the probe run it
+// is in. Taking whole runs keeps every remaining old entry reachable from
+// its home slot.
+static void migrate(hash_table_t* table, uint32_t budget){
+    hash_slot_t* old = table->old_slots;
+    uint32_t at = table->migrate_at;
+    while (table->old_count && (budget || old[at].key != HASH_EMPTY_KEY)) {
+        if (old[at].key != HASH_EMPTY_KEY) {
+            place_slot(table->slots, table->mask, old[at].key, old[at].value);
+            old[at].key = HASH_EMPTY_KEY;
+            table->old_count--;
+            table->count++;
+        }
+        at = (at + 1) & table->old_mask;
+        if (budget) budget--;
+    }
+    table->migrate_at = at;
+    if (table->old_count == 0) finish_grow(table);
+}
+
+static int start_grow(hash_table_t* table){
+    // A grow that is still running finishes first (only happens if one
+    // outruns HASH_MIGRATE_STEP, which the 3/4 limit rules out)
+    if (table->old_slots) migrate(table, UINT32_MAX);
+
+    uint32_t capacity = (table->mask + 1) * 2;
+    if (capacity == 0) return 0;
+    hash_slot_t* slots = alloc_slots(table->arena, capacity);
+    if (!slots) return 0;
+
+    table->old_slots = table->slots;
+    table->old_mask = table->mask;
+    table->old_count = table->count;
+    table->slots = slots;
+    table->mask = capacity - 1;
+    table->count = 0;
+    table->grows++;
+
+    // Start on an empty slot, so the first run moved is a whole one
+    uint32_t at = 0;
+    while (table->old_slots[at].key != HASH_EMPTY_KEY) at++;
+    table->migrate_at = at;
+    if (table->old_count == 0) finish_grow(table);
+    return 1;
+}
+
+hash_table_t* create_hash_table(arena_t* arena, uint32_t capacity){
+    if (!arena || arena->policy != LIFETIME_INTERMEDIATE) return NULL;
+
+    uint64_t wanted = (uint64_t)capacity * 4 / 3 + 1;
+    uint64_t slots = HASH_MIN_CAPACITY;
+    while (slots < wanted) slots <<= 1;
+    if (slots > (1ull << 31)) return NULL;
+
+    hash_table_t* table = (hash_table_t*)r_arena(arena, sizeof(hash_table_t), 0);
+    if (!table) return NULL;
+    memset(table, 0, sizeof(*table));
+    table->arena = arena;
+    table->slots = alloc_slots(arena, (uint32_t)slots);
+    if (!table->slots) {
+        r_arena_free(arena, table);
+        return NULL;
+    }
+    table->mask = (uint32_t)slots - 1;
+    table->rng = 0x9e3779b97f4a7c15ull ^ (uint64_t)(uintptr_t)table;
+    return table;
+}
+
+void destroy_hash_table(hash_table_t* table){
+    if (!table) return;
+    r_arena_free(table->arena, table->old_slots);
+    r_arena_free(table->arena, table->slots);
+    r_arena_free(table->arena, table);
+}
+
+int hash_put(hash_table_t* table, uint64_t key, uint64_t value){
+    if (key == HASH_EMPTY_KEY) return 0;
+    if (table->old_slots) migrate(table, HASH_MIGRATE_STEP);
+
+    int64_t i = find_slot(table->slots, table->mask, key);
+    if (i >= 0) {
+        table->slots[i].value = value;
+        return 1;
+    }
+    if (table->old_slots) {
+        i = find_slot(table->old_slots, table->old_mask, key);
+        if (i >= 0) {
+            table->old_slots[i].value = value;
+            return 1;
+        }
+    }
+
+    if ((uint64_t)(hash_count(table) + 1) * 4 > (uint64_t)(table->mask + 1) * 3 && !start_grow(table)) {
+        return 0;
+    }
+    place_slot(table->slots, table->mask, key, value);
+    table->count++;
+    return 1;
+}
+
+int hash_get(hash_table_t* table, uint64_t key, uint64_t* value){
+    if (key == HASH_EMPTY_KEY) return 0;
+    int64_t i = find_slot(table->slots, table->mask, key);
+    if (i >= 0) {
+        *value = table->slots[i].value;
+        return 1;
+    }
+    if (table->old_slots) {
+        i = find_slot(table->old_slots, table->old_mask, key);
+        if (i >= 0) {
+            *value = table->old_slots[i].value;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int hash_remove(hash_table_t* table, uint64_t key, uint64_t* value){
+    if (key == HASH_EMPTY_KEY) return 0;
+    if (table->old_slots) migrate(table, HASH_MIGRATE_STEP);
+
+    int64_t i = find_slot(table->slots, table->mask, key);
+    if (i >= 0) {
+        if (value) *value = table->slots[i].value;
+        clear_slot(table->slots, table->mask, (uint32_t)i);
+        table->count--;
+        return 1;
+    }
+    if (table->old_slots) {
+        i = find_slot(table->old_slots, table->old_mask, key);
+        if (i >= 0) {
+            if (value) *value = table->old_slots[i].value;
+            clear_slot(table->old_slots, table->old_mask, (uint32_t)i);
+            if (--table->old_count == 0) finish_grow(table);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Slot `i` of both arrays taken as one (the new one first)
+static inline hash_slot_t* slot_at(hash_table_t* table, uint64_t i){
+    return i <= table->mask ? &table->slots[i] : &table->old_slots[i - table->mask - 1];
+}
+
+int hash_sample(hash_table_t* table, uint64_t* key, uint64_t* value){
+    if (hash_count(table) == 0) return 0;
+    uint64_t total = (uint64_t)table->mask + 1 + (table->old_slots ? (uint64_t)table->old_mask + 1 : 0);
+
+    // Random slots until one is full: uniform over the entries. A table
+    // emptied far below its size falls back to walking from the last pick.
+    hash_slot_t* slot = NULL;
+    uint64_t i = 0;
+    for (int tries = 0; tries < 64; tries++) {
+        table->rng ^= table->rng << 13;
+        table->rng ^= table->rng >> 7;
+        table->rng ^= table->rng << 17;
+        i = (uint64_t)(((unsigned __int128)table->rng * total) >> 64);
+        slot = slot_at(table, i);
+        if (slot->key != HASH_EMPTY_KEY) break;
+    }
+    while (slot->key == HASH_EMPTY_KEY) {
+        i = i + 1 == total ? 0 : i + 1;
+        slot = slot_at(table, i);
+    }
+    *key = slot->key;
+    if (value) *value = slot->value;
+    return 1;
+}
+
+void hash_table_stats(hash_table_t* table, hash_table_stats_t* stats){
+    stats->count = hash_count(table);
+    stats->capacity = table->mask + 1;
+    stats->old_capacity = table->old_slots ? table->old_mask + 1 : 0;
+    stats->old_count = table->old_count;
+    stats->grows = table->grows;
+    stats->bytes = sizeof(hash_table_t) +
+                   ((size_t)stats->capacity + stats->old_capacity) * sizeof(hash_slot_t);
+}
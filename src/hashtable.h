@@ -0,0 +1,71 @@
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "arena.h"
+
+// uint64 -> uint64 map (user id -> session pointer ...) whose slots live in
+// an INTERMEDIATE arena. Open addressing with linear probing: one slot is
+// the key and the value side by side, and a lookup usually reads one cache
+// line. Removal shifts the rest of the probe run back, so there are no
+// tombstones and probe runs stay short under churn.
+//
+// Growing does not rehash everything at once. The table allocates a slot
+// array twice the size and keeps the old one until each put / remove has
+// moved HASH_MIGRATE_STEP old slots across; lookups check both meanwhile.
+// Moves always finish the probe run they are in, so what is left of the old
+// array stays a valid table. The old array goes back to the arena once it
+// is empty.
+#define HASH_EMPTY_KEY UINT64_MAX  // marks a free slot, so it cannot be a key
+#define HASH_MIN_CAPACITY 16
+#define HASH_MIGRATE_STEP 8
+
+typedef struct hash_slot_t {
+    uint64_t key;
+    uint64_t value;
+} hash_slot_t;
+
+typedef struct hash_table_t {
+    arena_t* arena;
+    hash_slot_t* slots;      // power of two slots, at most 3/4 full
+    uint32_t mask;
+    uint32_t count;          // entries in `slots`
+    hash_slot_t* old_slots;  // while growing: entries not moved yet, else NULL
+    uint32_t old_mask;
+    uint32_t old_count;
+    uint32_t migrate_at;     // next old slot to move
+    uint32_t grows;
+    uint64_t rng;            // hash_sample state
+} hash_table_t;
+
+typedef struct hash_table_stats_t {
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t old_capacity;   // 0 unless a grow is in progress
+    uint32_t old_count;
+    uint32_t grows;
+    size_t bytes;            // header and slot arrays
+} hash_table_stats_t;
+
+// Room for `capacity` entries before the first grow. NULL if the arena is
+// not INTERMEDIATE or is out of memory. r_reset / r_destroy drop the table.
+hash_table_t* create_hash_table(arena_t* arena, uint32_t capacity);
+// Gives the memory back to the arena
+void destroy_hash_table(hash_table_t* table);
+
+// Inserts or replaces. 0 for HASH_EMPTY_KEY or when a grow runs out of memory.
+int hash_put(hash_table_t* table, uint64_t key, uint64_t value);
+// 0 if absent
+int hash_get(hash_table_t* table, uint64_t key, uint64_t* value);
+// 0 if absent, else the removed value goes to `value` (may be NULL)
+int hash_remove(hash_table_t* table, uint64_t key, uint64_t* value);
+// A random entry (uniform unless the table is mostly empty). 0 if none.
+int hash_sample(hash_table_t* table, uint64_t* key, uint64_t* value);
+void hash_table_stats(hash_table_t* table, hash_table_stats_t* stats);
+
+static inline uint32_t hash_count(hash_table_t* table) {
+    return table->count + table->old_count;
+}
+
+#endif
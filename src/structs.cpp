@@ -0,0 +1,144 @@
+#include "structs.h"
+#include <string.h>
+
+static const char* FIELD_TYPE_NAMES[FIELD_TYPE_COUNT] = {
+    "u8", "i8", "u16", "i16", "u32", "i32", "f32", "u64", "i64", "f64"
+};
+static const uint8_t FIELD_TYPE_SIZES[FIELD_TYPE_COUNT] = {
+    1, 1, 2, 2, 4, 4, 4, 8, 8, 8
+};
+
+int field_type_from_name(const char* name){
+    for (int i = 0; i < FIELD_TYPE_COUNT; i++) {
+        if (strcmp(name, FIELD_TYPE_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+size_t field_type_size(field_type_t type){
+    return FIELD_TYPE_SIZES[type];
+}
+
+int struct_schema_init(struct_schema_t* schema, const char* const* names,
+                       const field_type_t* types, uint32_t count){
+    if (count == 0 || count > STRUCT_MAX_FIELDS) return 0;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t length = strlen(names[i]);
+        if (length == 0 || length >= STRUCT_NAME_MAX) return 0;
+        if ((unsigned)types[i] >= FIELD_TYPE_COUNT) return 0;
+        for (uint32_t j = 0; j < i; j++) {
+            if (strcmp(names[i], names[j]) == 0) return 0;
+        }
+    }
+
+    struct_schema_t layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.field_count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        strcpy(layout.fields[i].name, names[i]);
+        layout.fields[i].type = (uint8_t)types[i];
+        layout.fields[i].size = FIELD_TYPE_SIZES[types[i]];
+    }
+
+    // Largest first: every offset is then a multiple of the field's size
+    uint32_t offset = 0;
+    for (int size = 8; size >= 1; size /= 2) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (layout.fields[i].size != size) continue;
+            layout.fields[i].offset = (uint16_t)offset;
+            offset += size;
+            if (layout.align < (uint32_t)size) layout.align = size;
+        }
+    }
+    layout.size = (offset + layout.align - 1) & ~(layout.align - 1);
+    *schema = layout;
+    return 1;
+}
+
+int struct_field_index(const struct_schema_t* schema, const char* name){
+    for (uint32_t i = 0; i < schema->field_count; i++) {
+        if (strcmp(schema->fields[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// Blocks start on a cache line, so a column scan never straddles one it
+// does not need
+static void* table_block(arena_t* arena, size_t size){
+    return r_arena_aligned(arena, size, CACHE_LINE_SIZE, 0);
+}
+
+struct_table_t* create_struct_table(arena_t* arena, const struct_schema_t* schema,
+                                    uint32_t capacity, struct_layout_t layout){
+    if (!arena || arena->policy != LIFETIME_INTERMEDIATE) return NULL;
+    if (capacity == 0 || capacity == STRUCT_NO_ROW || schema->field_count == 0) return NULL;
+
+    struct_table_t* table = (struct_table_t*)r_arena(arena, sizeof(struct_table_t), 0);
+    if (!table) return NULL;
+    memset(table, 0, sizeof(*table));
+    table->arena = arena;
+    table->schema = *schema;
+    table->layout = layout;
+    table->capacity = capacity;
+
+    table->free_rows = (uint32_t*)table_block(arena, (size_t)capacity * sizeof(uint32_t));
+    table->live = (uint64_t*)table_block(arena, ((size_t)capacity + 63) / 64 * sizeof(uint64_t));
+    int ok = table->free_rows && table->live;
+    if (ok && layout == STRUCT_AOS) {
+        table->data = table_block(arena, (size_t)capacity * schema->size);
+        ok = table->data != NULL;
+    } else if (ok) {
+        for (uint32_t i = 0; i < schema->field_count && ok; i++) {
+            table->columns[i] = table_block(arena, (size_t)capacity * schema->fields[i].size);
+            ok = table->columns[i] != NULL;
+        }
+    }
+    if (!ok) {
+        destroy_struct_table(table);
+        return NULL;
+    }
+    memset(table->live, 0, ((size_t)capacity + 63) / 64 * sizeof(uint64_t));
+    return table;
+}
+
+void destroy_struct_table(struct_table_t* table){
+    if (!table) return;
+    arena_t* arena = table->arena;
+    r_arena_free(arena, table->free_rows);
+    r_arena_free(arena, table->live);
+    r_arena_free(arena, table->data);
+    for (uint32_t i = 0; i < STRUCT_MAX_FIELDS; i++) r_arena_free(arena, table->columns[i]);
+    r_arena_free(arena, table);
+}
+
+uint32_t struct_alloc(struct_table_t* table){
+    uint32_t row;
+    if (table->free_top) {
+        row = table->free_rows[--table->free_top];
+    } else if (table->next_row < table->capacity) {
+        row = table->next_row++;
+    } else {
+        return STRUCT_NO_ROW;
+    }
+    table->live[row >> 6] |= 1ull << (row & 63);
+    table->count++;
+
+    if (table->layout == STRUCT_AOS) {
+        memset((char*)table->data + (size_t)row * table->schema.size, 0, table->schema.size);
+    } else {
+        for (uint32_t i = 0; i < table->schema.field_count; i++) {
+            memset(struct_field(table, row, i), 0, table->schema.fields[i].size);
+        }
+    }
+    return row;
+}
+
+int struct_free(struct_table_t* table, uint32_t row){
+    if (row >= table->next_row) return 0;
+    uint64_t bit = 1ull << (row & 63);
+    if (!(table->live[row >> 6] & bit)) return 0;
+    table->live[row >> 6] &= ~bit;
+    table->free_rows[table->free_top++] = row;
+    table->count--;
+    return 1;
+}
@@ -0,0 +1,95 @@
+#ifndef STRUCTS_H
+#define STRUCTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "arena.h"
+
+// Fixed-shape records (sessions, counters ...) kept in an INTERMEDIATE
+// arena instead of V8 objects. A schema is declared once; a table then
+// holds up to `capacity` records of it, addressed by row number, in one
+// of two layouts:
+//   STRUCT_AOS  records back to back, fields at fixed offsets: one record
+//               is one or two cache lines (point access)
+//   STRUCT_SOA  one column per field: a scan over a field reads
+//               contiguous memory
+// Fields are laid out largest first, so records need no inner padding and
+// every field is naturally aligned in both layouts.
+#define STRUCT_MAX_FIELDS 32
+#define STRUCT_NAME_MAX 32
+#define STRUCT_NO_ROW 0xffffffffu
+
+typedef enum {
+    FIELD_U8, FIELD_I8,
+    FIELD_U16, FIELD_I16,
+    FIELD_U32, FIELD_I32, FIELD_F32,
+    FIELD_U64, FIELD_I64, FIELD_F64,
+    FIELD_TYPE_COUNT
+} field_type_t;
+
+typedef enum {
+    STRUCT_AOS,
+    STRUCT_SOA
+} struct_layout_t;
+
+typedef struct struct_field_t {
+    char name[STRUCT_NAME_MAX];
+    uint8_t type;        // field_type_t
+    uint8_t size;        // bytes, also its alignment
+    uint16_t offset;     // within a record (STRUCT_AOS)
+} struct_field_t;
+
+typedef struct struct_schema_t {
+    uint32_t field_count;
+    uint32_t size;       // record size, a multiple of `align`
+    uint32_t align;      // largest field
+    struct_field_t fields[STRUCT_MAX_FIELDS]; // in declaration order
+} struct_schema_t;
+
+// "u8", "i8", "u16", "i16", "u32", "i32", "f32", "u64", "i64", "f64"; -1 otherwise
+int field_type_from_name(const char* name);
+size_t field_type_size(field_type_t type);
+
+// Lays out `count` fields. Returns 0 (schema untouched) for no fields, too
+// many, an unknown type or a name that is empty, too long or repeated.
+int struct_schema_init(struct_schema_t* schema, const char* const* names,
+                       const field_type_t* types, uint32_t count);
+int struct_field_index(const struct_schema_t* schema, const char* name); // -1 if absent
+
+typedef struct struct_table_t {
+    arena_t* arena;
+    struct_schema_t schema;
+    struct_layout_t layout;
+    uint32_t capacity;
+    uint32_t count;      // live rows
+    uint32_t next_row;   // rows below it have been handed out at least once
+    uint32_t free_top;
+    uint32_t* free_rows; // released rows, reused last in first out
+    uint64_t* live;      // one bit per row
+    void* data;          // STRUCT_AOS: capacity * schema.size bytes
+    void* columns[STRUCT_MAX_FIELDS]; // STRUCT_SOA: capacity elements each
+} struct_table_t;
+
+// Everything comes out of `arena` (an INTERMEDIATE arena: tables too big
+// for a slab become its large objects), so r_reset / r_destroy drop them.
+// Returns NULL if the arena is not INTERMEDIATE or is out of memory.
+struct_table_t* create_struct_table(arena_t* arena, const struct_schema_t* schema,
+                                    uint32_t capacity, struct_layout_t layout);
+// Gives the memory back to the arena
+void destroy_struct_table(struct_table_t* table);
+
+// A zeroed row, or STRUCT_NO_ROW when the table is full
+uint32_t struct_alloc(struct_table_t* table);
+// 0 if `row` is out of range or not live
+int struct_free(struct_table_t* table, uint32_t row);
+
+// Address of one field of one row (no checks)
+static inline void* struct_field(struct_table_t* table, uint32_t row, uint32_t field) {
+    const struct_field_t* f = &table->schema.fields[field];
+    if (table->layout == STRUCT_AOS) {
+        return (char*)table->data + (size_t)row * table->schema.size + f->offset;
+    }
+    return (char*)table->columns[field] + (size_t)row * f->size;
+}
+
+#endif
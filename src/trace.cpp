@@ -0,0 +1,181 @@
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+// Objects allocated before the trace started are not in the maps, so
+// their frees are skipped: the replayer never allocated them either.
+// An arena's objects are also listed under the arena, so a reset or
+// destroy drops their ids: a later free of such a pointer is a no-op in
+// the app, and must not reach the trace with an id the replayer has
+// already let go of.
+struct traced_object_t {
+    uint32_t id;
+    uint32_t arena;         // 0 for the general heap
+};
+
+static std::mutex trace_lock;
+static FILE* trace_file = NULL;
+static int trace_active = 0;
+static size_t trace_records = 0;
+static uint32_t next_object_id = 1;
+static uint32_t next_arena_id = 1;
+static std::unordered_map<uintptr_t, traced_object_t> object_ids;
+static std::unordered_map<uintptr_t, uint32_t> arena_ids;
+static std::unordered_map<uint32_t, std::unordered_set<uintptr_t>> arena_objects;
+
+int trace_start(const char* path) {
+    std::lock_guard<std::mutex> guard(trace_lock);
+    if (trace_file) return 0;
+
+    trace_file = fopen(path, "wb");
+    if (!trace_file) return 0;
+
+    trace_header_t header;
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.record_size = sizeof(trace_record_t);
+    header.reserved = 0;
+    fwrite(&header, sizeof(header), 1, trace_file);
+
+    trace_records = 0;
+    next_object_id = 1;
+    next_arena_id = 1;
+    object_ids.clear();
+    arena_ids.clear();
+    arena_objects.clear();
+    __atomic_store_n(&trace_active, 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+size_t trace_stop() {
+    std::lock_guard<std::mutex> guard(trace_lock);
+    __atomic_store_n(&trace_active, 0, __ATOMIC_RELEASE);
+    if (!trace_file) return 0;
+
+    fclose(trace_file);
+    trace_file = NULL;
+    object_ids.clear();
+    arena_ids.clear();
+    arena_objects.clear();
+    return trace_records;
+}
+
+// Caller holds trace_lock
+static void emit(uint8_t op, uint32_t arena, uint32_t id, uint64_t size, uint32_t site_id,
+                 uint32_t arg = 0, uint8_t policy = 0, uint64_t max_size = 0) {
+    trace_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.op = op;
+    record.policy = policy;
+    record.arg = (uint16_t)arg;
+    record.arena = arena;
+    record.id = id;
+    record.size = size;
+    record.max_size = max_size;
+    record.site_id = site_id;
+    fwrite(&record, sizeof(record), 1, trace_file);
+    trace_records++;
+}
+
+// Caller holds trace_lock. 0 = not seen since the trace started.
+static uint32_t lookup(std::unordered_map<uintptr_t, uint32_t>& ids, void* ptr, bool erase) {
+    auto it = ids.find((uintptr_t)ptr);
+    if (it == ids.end()) return 0;
+    uint32_t id = it->second;
+    if (erase) ids.erase(it);
+    return id;
+}
+
+// Caller holds trace_lock. Binds `ptr` to a new object id; an address
+// handed out again (after a free, or by a bump arena after a reset)
+// simply moves to the new id.
+static uint32_t bind_object(void* ptr, uint32_t arena) {
+    uint32_t id = next_object_id++;
+    object_ids[(uintptr_t)ptr] = traced_object_t{id, arena};
+    if (arena) arena_objects[arena].insert((uintptr_t)ptr);
+    return id;
+}
+
+// Caller holds trace_lock. Unbinds `ptr` and returns its id, or 0 if it
+// is not a live object of `arena`.
+static uint32_t take_object(void* ptr, uint32_t arena) {
+    auto it = object_ids.find((uintptr_t)ptr);
+    if (it == object_ids.end() || it->second.arena != arena) return 0;
+    uint32_t id = it->second.id;
+    object_ids.erase(it);
+    if (arena) arena_objects[arena].erase((uintptr_t)ptr);
+    return id;
+}
+
+// Caller holds trace_lock. Unbinds everything `arena` still holds.
+// Addresses since rebound elsewhere belong to their new owner and stay.
+static void drop_arena_objects(uint32_t arena) {
+    auto list = arena_objects.find(arena);
+    if (list == arena_objects.end()) return;
+    for (uintptr_t ptr : list->second) {
+        auto it = object_ids.find(ptr);
+        if (it != object_ids.end() && it->second.arena == arena) object_ids.erase(it);
+    }
+    arena_objects.erase(list);
+}
+
+#define TRACE_GUARD() \
+    if (!__atomic_load_n(&trace_active, __ATOMIC_ACQUIRE)) return; \
+    std::lock_guard<std::mutex> guard(trace_lock); \
+    if (!trace_file) return
+
+void trace_alloc(void* ptr, size_t size, uint32_t align, uint32_t site_id) {
+    if (!ptr) return;
+    TRACE_GUARD();
+    uint32_t id = bind_object(ptr, 0);
+    emit(TRACE_ALLOC, 0, id, size, site_id, align);
+}
+
+void trace_free(void* ptr) {
+    TRACE_GUARD();
+    uint32_t id = take_object(ptr, 0);
+    if (id) emit(TRACE_FREE, 0, id, 0, 0);
+}
+
+void trace_arena_create(void* arena, size_t size, int policy, size_t max_size, uint32_t flags) {
+    if (!arena) return;
+    TRACE_GUARD();
+    uint32_t id = next_arena_id++;
+    arena_ids[(uintptr_t)arena] = id;
+    emit(TRACE_ARENA_CREATE, id, 0, size, 0, flags, (uint8_t)policy, max_size);
+}
+
+void trace_arena_alloc(void* arena, void* ptr, size_t size, uint32_t align, uint32_t site_id) {
+    if (!ptr) return;
+    TRACE_GUARD();
+    uint32_t arena_id = lookup(arena_ids, arena, false);
+    if (!arena_id) return;
+    uint32_t id = bind_object(ptr, arena_id);
+    emit(TRACE_ARENA_ALLOC, arena_id, id, size, site_id, align);
+}
+
+void trace_arena_free(void* arena, void* ptr) {
+    TRACE_GUARD();
+    uint32_t arena_id = lookup(arena_ids, arena, false);
+    uint32_t id = arena_id ? take_object(ptr, arena_id) : 0;
+    if (id) emit(TRACE_ARENA_FREE, arena_id, id, 0, 0);
+}
+
+void trace_arena_reset(void* arena) {
+    TRACE_GUARD();
+    uint32_t arena_id = lookup(arena_ids, arena, false);
+    if (!arena_id) return;
+    drop_arena_objects(arena_id);
+    emit(TRACE_ARENA_RESET, arena_id, 0, 0, 0);
+}
+
+void trace_arena_destroy(void* arena) {
+    TRACE_GUARD();
+    uint32_t arena_id = lookup(arena_ids, arena, true);
+    if (!arena_id) return;
+    drop_arena_objects(arena_id);
+    emit(TRACE_ARENA_DESTROY, arena_id, 0, 0, 0);
+}
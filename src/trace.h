@@ -0,0 +1,59 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Allocation trace: the exact sequence of allocator calls made through the
+// JS boundary, for bench/replay.cpp to re-run natively. Pointers are
+// replaced by dense ids (assigned in allocation order), so the replayer
+// can keep live objects in a flat array. Mark/rewind is not recorded, so
+// traces of apps that rewind arenas replay as if they never did.
+//
+// File layout: one trace_header_t, then trace_record_t back to back.
+#define TRACE_MAGIC 0x43525452 // "RTRC"
+#define TRACE_VERSION 1
+
+enum trace_op_t {
+    TRACE_ALLOC = 1,        // r_alloc(size, site) / r_alloc_aligned -> id
+    TRACE_FREE,             // r_free(id)
+    TRACE_ARENA_CREATE,     // create_arena_ex(size, policy, max_size, flags) -> arena
+    TRACE_ARENA_ALLOC,      // r_arena(arena, size, site) / r_arena_aligned -> id
+    TRACE_ARENA_FREE,       // r_arena_free(arena, id)
+    TRACE_ARENA_RESET,      // r_reset(arena)
+    TRACE_ARENA_DESTROY     // r_destroy(arena)
+};
+
+typedef struct trace_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+} trace_header_t;
+
+typedef struct trace_record_t {
+    uint8_t op;             // trace_op_t
+    uint8_t policy;         // TRACE_ARENA_CREATE only
+    uint16_t arg;           // ALLOC ops: alignment (0 = default), TRACE_ARENA_CREATE: ARENA_* flags
+    uint32_t site_id;
+    uint32_t id;            // object id (ALLOC/FREE ops), 0 if unused
+    uint32_t arena;         // arena id, 0 for the general heap
+    uint64_t size;          // request size (initial capacity for TRACE_ARENA_CREATE)
+    uint64_t max_size;      // TRACE_ARENA_CREATE only
+} trace_record_t;
+
+// Recorder, used by the addon wrappers. All calls are no-ops unless a
+// trace is running; they are safe to call from any worker.
+int trace_start(const char* path);  // 0 if the file could not be created
+size_t trace_stop();                // records written
+
+// align = 0 for the default alignment
+void trace_alloc(void* ptr, size_t size, uint32_t align, uint32_t site_id);
+void trace_free(void* ptr);
+void trace_arena_create(void* arena, size_t size, int policy, size_t max_size, uint32_t flags);
+void trace_arena_alloc(void* arena, void* ptr, size_t size, uint32_t align, uint32_t site_id);
+void trace_arena_free(void* arena, void* ptr);
+void trace_arena_reset(void* arena);
+void trace_arena_destroy(void* arena);
+
+#endif
@@ -0,0 +1,142 @@
+#include "views.h"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+struct view_entry_t {
+    napi_ref ref;         // weak reference to the ArrayBuffer
+    uint64_t ptr_key;
+    uint64_t arena_key;
+    const char* data;     // memory the view covers
+    size_t length;
+    bool detached;        // already unregistered, only the finalizer is left
+    view_registry_t* registry;
+};
+
+typedef std::unordered_map<uint64_t, std::vector<view_entry_t*>> view_map_t;
+
+struct view_registry_t {
+    view_map_t by_ptr;
+    view_map_t by_arena;
+    size_t live_entries;  // entries whose finalizer has not run yet
+    bool closing;         // env is gone, delete once live_entries hits 0
+};
+
+view_registry_t* create_view_registry() {
+    view_registry_t* registry = new view_registry_t();
+    registry->live_entries = 0;
+    registry->closing = false;
+    return registry;
+}
+
+// ArrayBuffer finalizers can run after the env's instance data is gone,
+// so the registry outlives the env until its last view is collected.
+void release_view_registry(view_registry_t* registry) {
+    registry->closing = true;
+    registry->by_ptr.clear();
+    registry->by_arena.clear();
+    if (registry->live_entries == 0) delete registry;
+}
+
+static void unlink_entry(view_map_t& map, uint64_t key, view_entry_t* entry) {
+    if (!key) return;
+    view_map_t::iterator it = map.find(key);
+    if (it == map.end()) return;
+    std::vector<view_entry_t*>& list = it->second;
+    list.erase(std::remove(list.begin(), list.end(), entry), list.end());
+    if (list.empty()) map.erase(it);
+}
+
+// GC collected the ArrayBuffer: drop the entry (the memory is not ours)
+static void finalize_view(napi_env env, void* data, void* hint) {
+    view_entry_t* entry = (view_entry_t*)hint;
+    view_registry_t* registry = entry->registry;
+    if (!entry->detached && !registry->closing) {
+        unlink_entry(registry->by_ptr, entry->ptr_key, entry);
+        unlink_entry(registry->by_arena, entry->arena_key, entry);
+    }
+    if (!registry->closing) napi_delete_reference(env, entry->ref);
+    delete entry;
+
+    if (--registry->live_entries == 0 && registry->closing) delete registry;
+}
+
+napi_value create_view(napi_env env, view_registry_t* registry, void* data, size_t length,
+                       uint64_t ptr_key, uint64_t arena_key) {
+    view_entry_t* entry = new view_entry_t();
+    entry->ptr_key = ptr_key;
+    entry->arena_key = arena_key;
+    entry->data = (const char*)data;
+    entry->length = length;
+    entry->detached = false;
+    entry->registry = registry;
+
+    napi_value buffer;
+    napi_status status = napi_create_external_arraybuffer(env, data, length, finalize_view,
+                                                          entry, &buffer);
+    if (status != napi_ok) {
+        delete entry;
+        napi_throw_error(env, NULL, "external ArrayBuffers are not allowed in this runtime");
+        return NULL;
+    }
+    registry->live_entries++;
+
+    napi_create_reference(env, buffer, 0, &entry->ref);
+    if (ptr_key) registry->by_ptr[ptr_key].push_back(entry);
+    if (arena_key) registry->by_arena[arena_key].push_back(entry);
+    return buffer;
+}
+
+static void detach_entries(napi_env env, std::vector<view_entry_t*>& list,
+                           view_map_t& other, bool other_is_arena) {
+    for (size_t i = 0; i < list.size(); i++) {
+        view_entry_t* entry = list[i];
+        unlink_entry(other, other_is_arena ? entry->arena_key : entry->ptr_key, entry);
+        entry->detached = true;
+
+        // The finalizer may run from inside the detach, don't touch entry after it
+        napi_value buffer = NULL;
+        napi_get_reference_value(env, entry->ref, &buffer);
+        if (buffer) napi_detach_arraybuffer(env, buffer);
+    }
+}
+
+static void detach_all(napi_env env, view_registry_t* registry, view_map_t& map, uint64_t key,
+                       view_map_t& other, bool other_is_arena) {
+    view_map_t::iterator it = map.find(key);
+    if (it == map.end()) return;
+    std::vector<view_entry_t*> list;
+    list.swap(it->second);
+    map.erase(it);
+    detach_entries(env, list, other, other_is_arena);
+}
+
+void detach_views_for_ptr(napi_env env, view_registry_t* registry, uint64_t ptr_key) {
+    if (registry->by_ptr.empty()) return; // fast path: no views handed out
+    detach_all(env, registry, registry->by_ptr, ptr_key, registry->by_arena, true);
+}
+
+void detach_views_for_arena(napi_env env, view_registry_t* registry, uint64_t arena_key) {
+    if (registry->by_arena.empty()) return;
+    detach_all(env, registry, registry->by_arena, arena_key, registry->by_ptr, false);
+}
+
+void detach_views_in_ranges(napi_env env, view_registry_t* registry, uint64_t arena_key,
+                            const view_range_t* ranges, size_t count) {
+    if (registry->by_arena.empty() || count == 0) return;
+    view_map_t::iterator it = registry->by_arena.find(arena_key);
+    if (it == registry->by_arena.end()) return;
+
+    std::vector<view_entry_t*> keep, gone;
+    for (size_t i = 0; i < it->second.size(); i++) {
+        view_entry_t* entry = it->second[i];
+        bool overlaps = false;
+        for (size_t r = 0; r < count && !overlaps; r++) {
+            overlaps = entry->data < ranges[r].end && entry->data + entry->length > ranges[r].start;
+        }
+        (overlaps ? gone : keep).push_back(entry);
+    }
+    if (keep.empty()) registry->by_arena.erase(it);
+    else it->second.swap(keep);
+    detach_entries(env, gone, registry->by_ptr, false);
+}
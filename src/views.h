@@ -0,0 +1,34 @@
+#ifndef VIEWS_H
+#define VIEWS_H
+
+#include <node_api.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Zero-copy JS views (external ArrayBuffers) over allocator memory.
+// The allocator owns the memory, so a view's finalizer never frees it.
+// Instead every view is registered under the pointer and/or arena it
+// covers, and is detached (byteLength -> 0) as soon as that memory is
+// freed, reset or destroyed, so JS can never touch a dangling block.
+typedef struct view_registry_t view_registry_t;
+
+view_registry_t* create_view_registry();
+void release_view_registry(view_registry_t* registry); // env teardown
+
+// ptr_key: allocation the view covers (0 = none), arena_key: owning arena (0 = none)
+napi_value create_view(napi_env env, view_registry_t* registry, void* data, size_t length,
+                       uint64_t ptr_key, uint64_t arena_key);
+
+void detach_views_for_ptr(napi_env env, view_registry_t* registry, uint64_t ptr_key);
+void detach_views_for_arena(napi_env env, view_registry_t* registry, uint64_t arena_key);
+
+// Detaches the views of `arena_key` that overlap any of `count` byte ranges
+// (memory a rewind gives back), and leaves the others attached
+typedef struct view_range_t {
+    const char* start;
+    const char* end;
+} view_range_t;
+void detach_views_in_ranges(napi_env env, view_registry_t* registry, uint64_t arena_key,
+                            const view_range_t* ranges, size_t count);
+
+#endif